@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "procstat.h"
+
+#include <QFile>
+
+quint64 qtmir::processStartTime(pid_t pid, const QString &procPath)
+{
+    QFile stat(QStringLiteral("%1/%2/stat").arg(procPath).arg(pid));
+    if (!stat.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    // "pid (comm) state ppid ...", comm may contain spaces and parentheses, the fields after it do not.
+    // starttime is the 22nd field, the 20th after comm.
+    const QByteArray line = stat.readAll();
+    const QList<QByteArray> fields = line.mid(line.lastIndexOf(')') + 2).split(' ');
+    return fields.count() > 19 ? fields[19].toULongLong() : 0;
+}
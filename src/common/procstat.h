@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_PROCSTAT_H
+#define QTMIR_PROCSTAT_H
+
+#include <QString>
+
+#include <sys/types.h>
+
+namespace qtmir {
+
+// Clock ticks since boot at which the process started, as read from <procPath>/<pid>/stat.
+// Together with the pid, it tells a process apart from a later one that got the same pid.
+// 0 if there is no such process.
+quint64 processStartTime(pid_t pid, const QString &procPath = QStringLiteral("/proc"));
+
+} // namespace qtmir
+
+#endif // QTMIR_PROCSTAT_H
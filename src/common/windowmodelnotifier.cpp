@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "windowmodelnotifier.h"
+
+#include <QMutexLocker>
+
+using namespace qtmir;
+
+void WindowModelNotifier::postWindowMoved(const miral::Window &window, const QPoint topLeft)
+{
+    QMutexLocker lock(&m_geometryMutex);
+
+    auto pending = m_pendingMoves.find(window);
+    if (pending != m_pendingMoves.end()) {
+        pending->second = topLeft;
+        ++m_collapsedMoves;
+        return; // already scheduled
+    }
+
+    m_pendingMoves.emplace(window, topLeft);
+    scheduleGeometryDelivery();
+}
+
+void WindowModelNotifier::postWindowResized(const miral::WindowInfo &windowInfo, const QSize size)
+{
+    QMutexLocker lock(&m_geometryMutex);
+
+    auto pending = m_pendingResizes.find(windowInfo.window());
+    if (pending != m_pendingResizes.end()) {
+        pending->second = std::make_pair(windowInfo, size);
+        ++m_collapsedResizes;
+        return; // already scheduled
+    }
+
+    m_pendingResizes.emplace(windowInfo.window(), std::make_pair(windowInfo, size));
+    scheduleGeometryDelivery();
+}
+
+void WindowModelNotifier::scheduleGeometryDelivery()
+{
+    if (!m_geometryDeliveryScheduled) {
+        m_geometryDeliveryScheduled = true;
+        QMetaObject::invokeMethod(this, "deliverGeometryChanges", Qt::QueuedConnection,
+                                  Q_ARG(quint64, m_geometryGeneration));
+    }
+}
+
+void WindowModelNotifier::deliverGeometryChanges(quint64 generation)
+{
+    QMutexLocker lock(&m_geometryMutex);
+    if (generation != m_geometryGeneration) {
+        return; // flushed meanwhile
+    }
+    m_geometryDeliveryScheduled = false;
+    emitGeometryChanges();
+}
+
+// The delivery already scheduled, if any, is queued ahead of the signal about to be emitted. Updates posted
+// after it, e.g. for a window that signal adds, need a delivery of their own queued after it.
+void WindowModelNotifier::flushGeometryChanges()
+{
+    QMutexLocker lock(&m_geometryMutex);
+    emitGeometryChanges();
+    ++m_geometryGeneration;
+    m_geometryDeliveryScheduled = false;
+}
+
+// Emitting under the lock, or a signal emitted by another thread right after its flush could be queued before
+// the geometry updates it flushed
+void WindowModelNotifier::emitGeometryChanges()
+{
+    WindowModelChanges changes;
+    std::map<miral::Window, std::pair<miral::WindowInfo, QSize>> resizes;
+    changes.moved.swap(m_pendingMoves);
+    resizes.swap(m_pendingResizes);
+
+    if (!changes.isEmpty()) {
+        Q_EMIT windowsChanged(changes);
+    }
+    for (const auto &resize : resizes) {
+        Q_EMIT windowResized(resize.second.first, resize.second.second);
+    }
+}
@@ -24,6 +24,12 @@
 
 #include <miral/window_info.h>
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <set>
+#include <vector>
+
 // Unity API
 #include <unity/shell/application/Mir.h>
 
@@ -67,32 +73,118 @@ struct ExtraWindowInfo {
 
 std::shared_ptr<ExtraWindowInfo> getExtraInfo(const miral::WindowInfo &windowInfo);
 
+/*
+  Changes made to windows during one window management transaction (between advise_begin and advise_end),
+  keeping only the latest value of each property of each window. Moves come from WindowModelNotifier::postWindowMoved
+  instead, which coalesces them across transactions.
+ */
+struct WindowModelChanges {
+    std::map<miral::Window, QPoint> moved;
+    std::map<miral::Window, Mir::State> stateChanged;
+    std::map<miral::Window, bool> focusChanged;
+    std::vector<miral::Window> raised; // last one ends up on top
+
+    bool isEmpty() const
+    {
+        return moved.empty() && stateChanged.empty() && focusChanged.empty() && raised.empty();
+    }
+
+    void raise(const std::vector<miral::Window> &windows)
+    {
+        // raising A then B is the same as raising the windows of A which are not in B, then B
+        const std::set<miral::Window> raisedAgain(windows.begin(), windows.end());
+        raised.erase(std::remove_if(raised.begin(), raised.end(),
+                                    [&](const miral::Window &window) { return raisedAgain.count(window) > 0; }),
+                     raised.end());
+        raised.insert(raised.end(), windows.begin(), windows.end());
+    }
+
+    // find(window) returns the MirSurface of a window, or null. raise(windows) is only called if some were raised.
+    template<typename Find, typename Raise>
+    void apply(Find find, Raise raise) const
+    {
+        for (const auto &stateChange : stateChanged) {
+            if (auto mirSurface = find(stateChange.first)) {
+                mirSurface->updateState(stateChange.second);
+            }
+        }
+        for (const auto &move : moved) {
+            if (auto mirSurface = find(move.first)) {
+                mirSurface->setPosition(move.second);
+            }
+        }
+        // focus losses first, so that two surfaces are never focused at once
+        for (const bool focused : {false, true}) {
+            for (const auto &focusChange : focusChanged) {
+                if (focusChange.second != focused) {
+                    continue;
+                }
+                if (auto mirSurface = find(focusChange.first)) {
+                    mirSurface->setFocused(focused);
+                }
+            }
+        }
+        if (!raised.empty()) {
+            raise(raised);
+        }
+    }
+};
+
 class WindowModelNotifier : public QObject
 {
     Q_OBJECT
 public:
     WindowModelNotifier() = default;
 
+    // Any thread. Window geometry updates are coalesced, only the latest one of each window is delivered, once
+    // the thread of the notifier gets to it. Moves are emitted as windowsChanged, resizes as windowResized.
+    void postWindowMoved(const miral::Window &window, const QPoint topLeft);
+    void postWindowResized(const miral::WindowInfo &windowInfo, const QSize size);
+
+    // Any thread. Emits the pending geometry updates right away. To be called before emitting any other
+    // signal whose order matters, so that it does not overtake the geometry updates posted before it. Flushing
+    // for every update would defeat the coalescing.
+    void flushGeometryChanges();
+
+    // Number of updates dropped because a newer one for the same window arrived before they were delivered
+    quint64 collapsedMoves() const { return m_collapsedMoves; }
+    quint64 collapsedResizes() const { return m_collapsedResizes; }
+
 Q_SIGNALS: // **Must used Queued Connection or else events will be out of order**
     void windowAdded(const qtmir::NewWindow &window);
     void windowRemoved(const miral::WindowInfo &window);
     void windowReady(const miral::WindowInfo &window);
-    void windowMoved(const miral::WindowInfo &window, const QPoint topLeft);
     void windowResized(const miral::WindowInfo &window, const QSize size);
     void windowStateChanged(const miral::WindowInfo &window, Mir::State state);
     void windowFocusChanged(const miral::WindowInfo &window, bool focused);
     void windowsRaised(const std::vector<miral::Window> &windows); // results in deep copy when passed over Queued connection:(
     void windowRequestedRaise(const miral::WindowInfo &window);
+    void windowsChanged(const qtmir::WindowModelChanges &changes); // all changes of a transaction at once
     void modificationsStarted();
     void modificationsEnded();
 
+private Q_SLOTS:
+    void deliverGeometryChanges(quint64 generation);
+
 private:
+    void scheduleGeometryDelivery(); // with m_geometryMutex locked
+    void emitGeometryChanges(); // with m_geometryMutex locked
+
+    QMutex m_geometryMutex;
+    std::map<miral::Window, QPoint> m_pendingMoves;
+    std::map<miral::Window, std::pair<miral::WindowInfo, QSize>> m_pendingResizes;
+    bool m_geometryDeliveryScheduled{false};
+    quint64 m_geometryGeneration{0}; // advanced by flushes, deliveries scheduled before one have nothing to do
+    std::atomic<quint64> m_collapsedMoves{0};
+    std::atomic<quint64> m_collapsedResizes{0};
+
     Q_DISABLE_COPY(WindowModelNotifier)
 };
 
 } // namespace qtmir
 
 Q_DECLARE_METATYPE(qtmir::NewWindow)
+Q_DECLARE_METATYPE(qtmir::WindowModelChanges)
 Q_DECLARE_METATYPE(miral::WindowInfo)
 Q_DECLARE_METATYPE(std::vector<miral::Window>)
 Q_DECLARE_METATYPE(MirWindowState)
@@ -19,6 +19,7 @@
 #include "applicationinfo.h"
 #include "application_manager.h"
 #include "mirsurfaceinterface.h"
+#include "qmlcachecleaner.h"
 #include "session.h"
 #include "sharedwakelock.h"
 #include "timer.h"
@@ -72,6 +73,11 @@ Application::Application(const QSharedPointer<SharedWakelock>& sharedWakelock,
     setStopTimer(new Timer);
 
     connect(&m_surfaceList, &unityapp::MirSurfaceListInterface::countChanged, this, &unityapp::ApplicationInfoInterface::surfaceCountChanged);
+    connect(&m_surfaceList, &unityapp::MirSurfaceListInterface::countChanged, this, [this](int count) {
+        if (count > 0) {
+            m_launchTimeline.mark(LaunchTimeline::FirstSurface);
+        }
+    });
 }
 
 Application::~Application()
@@ -113,16 +119,10 @@ Application::~Application()
 
 void Application::wipeQMLCache()
 {
-    QString path(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/QML/Apps/"));
-    QDir dir(path);
-    QStringList apps = dir.entryList();
-    for (int i = 0; i < apps.size(); i++) {
-        if (apps.at(i).contains(appId())) {
-            qCDebug(QTMIR_APPLICATIONS) << "Application appId=" << apps.at(i) << " Wiping QML Cache";
-            dir.cd(apps.at(i));
-            dir.removeRecursively();
-            break;
-        }
+    if (m_qmlCacheCleaner) {
+        m_qmlCacheCleaner->wipe(appId());
+    } else {
+        QmlCacheCleaner().wipe(appId());
     }
 }
 
@@ -476,6 +476,7 @@ void Application::addSession(SessionInterface *newSession)
 
     bool oldFullscreen = fullscreen();
     m_sessions << newSession;
+    m_launchTimeline.mark(LaunchTimeline::SessionStarted);
 
     newSession->setParent(this);
     newSession->setApplication(this);
@@ -574,6 +575,7 @@ void Application::setProcessState(ProcessState newProcessState)
         break;
     case ProcessRunning:
         if (m_state == InternalState::StoppedResumable) {
+            m_launchTimeline.reset(); // relaunched by someone else
             setInternalState(InternalState::Starting);
         }
         break;
@@ -659,6 +661,9 @@ void Application::respawn()
 {
     INFO_MSG << "()";
 
+    m_launchTimeline.reset();
+    m_launchTimeline.mark(LaunchTimeline::Requested);
+
     setInternalState(InternalState::Starting);
 
     Q_EMIT startProcessRequested();
@@ -745,6 +750,10 @@ void Application::onSessionStateChanged()
         break;
     case Session::Running:
         if (m_state == InternalState::Starting) {
+            if (!m_launchTimeline.reached(LaunchTimeline::FirstFrame)) {
+                m_launchTimeline.mark(LaunchTimeline::FirstFrame);
+                INFO_MSG << "() - launch timeline (ms): " << m_launchTimeline.toVariantMap();
+            }
             setInternalState(InternalState::Running);
         }
         break;
@@ -29,6 +29,7 @@
 // Unity API
 #include <unity/shell/application/ApplicationInfoInterface.h>
 
+#include "launchtimeline.h"
 #include "mirsurfacelistmodel.h"
 #include "session_interface.h"
 
@@ -37,6 +38,7 @@ namespace qtmir
 
 class ApplicationManager;
 class ApplicationInfo;
+class QmlCacheCleaner;
 class Session;
 class SharedWakelock;
 class AbstractTimer;
@@ -127,9 +129,15 @@ public:
 
     void terminate();
 
+    LaunchTimeline &launchTimeline() { return m_launchTimeline; }
+    const LaunchTimeline &launchTimeline() const { return m_launchTimeline; }
+
     // for tests
     void setStopTimer(AbstractTimer *timer);
     AbstractTimer *stopTimer() const { return m_stopTimer; }
+
+    // Wipes done synchronously without one
+    void setQmlCacheCleaner(const QSharedPointer<QmlCacheCleaner> &cleaner) { m_qmlCacheCleaner = cleaner; }
 Q_SIGNALS:
     void fullscreenChanged(bool fullscreen);
 
@@ -174,9 +182,11 @@ private:
     RequestedState m_requestedState;
     ProcessState m_processState;
     AbstractTimer *m_stopTimer;
+    QSharedPointer<QmlCacheCleaner> m_qmlCacheCleaner;
     bool m_exemptFromLifecycle;
     QSize m_initialSurfaceSize;
     bool m_closing{false};
+    LaunchTimeline m_launchTimeline;
 
     mutable MirSurfaceListModel m_surfaceList;
     ProxySurfaceListModel *m_proxyPromptSurfaceList;
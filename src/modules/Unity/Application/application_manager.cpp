@@ -19,7 +19,10 @@
 #include "application.h"
 #include "applicationinfo.h"
 #include "dbusfocusinfo.h"
+#include "dbuslaunchinfo.h"
+#include "memorypolicy.h"
 #include "mirsurfaceinterface.h"
+#include "qmlcachecleaner.h"
 #include "session.h"
 #include "sharedwakelock.h"
 #include "proc_info.h"
@@ -42,9 +45,13 @@
 #include <QDebug>
 #include <QByteArray>
 #include <QDir>
+#include <QFile>
+#include <QRegularExpression>
 
 // std
+#include <algorithm>
 #include <csignal>
+#include <thread>
 
 // Unity API
 #include <unity/shell/application/MirSurfaceInterface.h>
@@ -62,8 +69,13 @@ namespace {
 
 // FIXME: To be removed once shell has fully adopted short appIds!!
 QString toShortAppIdIfPossible(const QString &appId) {
-    QRegExp longAppIdMask(QStringLiteral("[a-z0-9][a-z0-9+.-]+_[a-zA-Z0-9+.-]+_[0-9][a-zA-Z0-9.+:~-]*"));
-    if (longAppIdMask.exactMatch(appId)) {
+    // Runs for every lookup by appId, most of which are short already: no underscore or just one
+    if (appId.count('_') != 2) {
+        return appId;
+    }
+    static const QRegularExpression longAppIdMask(
+        QStringLiteral("^[a-z0-9][a-z0-9+.-]+_[a-zA-Z0-9+.-]+_[0-9][a-zA-Z0-9.+:~-]*$"));
+    if (longAppIdMask.match(appId).hasMatch()) {
         qWarning() << "WARNING: long App ID encountered:" << appId;
         // input string a long AppId, chop the version string off the end
         QStringList parts = appId.split(QStringLiteral("_"));
@@ -72,6 +84,24 @@ QString toShortAppIdIfPossible(const QString &appId) {
     return appId;
 }
 
+/*
+   The shell shows the splash image of a launching application right away: pull it into the page cache
+   while the process gets spawned. Runs on a thread of its own, nobody waits for it.
+ */
+void prefetchSplashImage(const QUrl &splashImage)
+{
+    if (!splashImage.isLocalFile()) {
+        return;
+    }
+
+    std::thread([path = splashImage.toLocalFile()]() {
+        QFile file(path);
+        if (file.open(QIODevice::ReadOnly)) {
+            while (!file.read(64 * 1024).isEmpty()) {}
+        }
+    }).detach();
+}
+
 } // namespace
 
 ApplicationManager* ApplicationManager::create()
@@ -104,6 +134,20 @@ ApplicationManager* ApplicationManager::create()
                                              settings
                                          );
 
+    // Registered on the session bus here rather than in the constructor, so that tests can create
+    // ApplicationManagers of their own. Owned by appManager.
+    new DBusLaunchInfo(appManager);
+
+    // Not done by the constructor either, tests must not touch the real cache
+    appManager->m_qmlCacheCleaner->removeLeftovers();
+
+    auto memoryPolicy = new MemoryPolicy(appManager,
+                                         QSharedPointer<MemoryPressureSource>(new ProcMemoryPressureSource),
+                                         procInfo,
+                                         settings,
+                                         appManager);
+    memoryPolicy->start();
+
     // Emit signal to notify Upstart that Mir is ready to receive client connections
     // see http://upstart.ubuntu.com/cookbook/#expect-stop
     // FIXME: should not be qtmir's job, instead should notify the user of this library
@@ -138,6 +182,7 @@ ApplicationManager::ApplicationManager(
     , m_procInfo(procInfo)
     , m_sharedWakelock(sharedWakelock)
     , m_settings(settings)
+    , m_qmlCacheCleaner(new QmlCacheCleaner)
     , m_mutex(QMutex::Recursive) // Needs to be recursive since e.g. beginInsertRows will call rowCount
 {
     qCDebug(QTMIR_APPLICATIONS) << "ApplicationManager::ApplicationManager (this=%p)" << this;
@@ -226,14 +271,7 @@ Application* ApplicationManager::findApplicationMutexHeld(const QString &inputAp
 {
     // We don't really need this function since the mutex is recursive but is a bit
     // better if we just lock the mutex recursively when really need it
-    const QString appId = toShortAppIdIfPossible(inputAppId);
-
-    for (Application *app : m_applications) {
-        if (app->appId() == appId) {
-            return app;
-        }
-    }
-    return nullptr;
+    return m_applicationsById.value(toShortAppIdIfPossible(inputAppId), nullptr);
 }
 
 bool ApplicationManager::requestFocusApplication(const QString &inputAppId)
@@ -313,6 +351,8 @@ Application* ApplicationManager::startApplication(const QString &inputAppId,
         }
     }
 
+    const int64_t requested = LaunchTimeline::now();
+
     if (!m_taskController->start(appId, arguments)) {
         qWarning() << "Upstart failed to start application with appId" << appId;
         return nullptr;
@@ -323,11 +363,13 @@ Application* ApplicationManager::startApplication(const QString &inputAppId,
     if (application) {
         application->setArguments(arguments);
     } else {
+        // Looked up with m_mutex held like every ubuntu-app-launch call, the process spawns meanwhile
         auto appInfo = m_taskController->getInfoForApp(appId);
         if (!appInfo) {
             qCWarning(QTMIR_APPLICATIONS) << "ApplicationManager::startApplication - Unable to instantiate application with appId" << appId;
             return nullptr;
         }
+        prefetchSplashImage(appInfo->splashImage());
 
         application = new Application(
                     m_sharedWakelock,
@@ -337,9 +379,44 @@ Application* ApplicationManager::startApplication(const QString &inputAppId,
 
         add(application);
     }
+    application->launchTimeline().mark(LaunchTimeline::Requested, requested);
     return application;
 }
 
+QVariantMap ApplicationManager::startupTimeline(const QString &inputAppId) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    Application *application = findApplicationMutexHeld(inputAppId);
+    return application ? application->launchTimeline().toVariantMap() : QVariantMap();
+}
+
+QVariantMap ApplicationManager::lifecycleLatency(const QString &inputAppId) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    Application *application = findApplicationMutexHeld(inputAppId);
+    if (!application) {
+        return QVariantMap();
+    }
+
+    // The application is only as quick as the slowest of its sessions
+    QVariantMap latencies;
+    for (SessionInterface *sessionInterface : application->sessions()) {
+        auto session = dynamic_cast<Session*>(sessionInterface);
+        if (!session) {
+            continue;
+        }
+        const QVariantMap sessionLatencies = session->lifecycleLatency().toVariantMap();
+        for (auto it = sessionLatencies.cbegin(); it != sessionLatencies.cend(); ++it) {
+            if (!latencies.contains(it.key()) || it.value().toLongLong() > latencies[it.key()].toLongLong()) {
+                latencies[it.key()] = it.value();
+            }
+        }
+    }
+    return latencies;
+}
+
 void ApplicationManager::onProcessStarting(const QString &appId)
 {
     QMutexLocker locker(&m_mutex);
@@ -375,6 +452,7 @@ void ApplicationManager::onProcessStarting(const QString &appId)
         }
     }
     application->setProcessState(Application::ProcessRunning);
+    application->launchTimeline().mark(LaunchTimeline::ProcessStarting);
 }
 
 /**
@@ -501,38 +579,76 @@ void ApplicationManager::onResumeRequested(const QString& appId)
     }
 }
 
-void ApplicationManager::onAppDataChanged(const int role)
+void ApplicationManager::onAppDataChanged(Application *application, const int role)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_dirtyApplications.insert(application);
+    if (!m_dirtyRoles.contains(role)) {
+        m_dirtyRoles.append(role);
+    }
+
+    // A state transition changes several roles in a row, let bindings be re-evaluated just once for all of them
+    if (!m_dataChangesPending) {
+        m_dataChangesPending = true;
+        QMetaObject::invokeMethod(this, "flushDataChanges", Qt::QueuedConnection);
+    }
+}
+
+void ApplicationManager::flushDataChanges()
 {
     QMutexLocker locker(&m_mutex);
-    if (sender()) {
-        Application *application = static_cast<Application*>(sender());
-        QModelIndex appIndex = findIndex(application);
-        Q_EMIT dataChanged(appIndex, appIndex, QVector<int>() << role);
+
+    m_dataChangesPending = false;
+
+    int firstRow = m_applications.count();
+    int lastRow = -1;
+    Q_FOREACH (Application *application, m_dirtyApplications) {
+        const int row = m_applications.indexOf(application);
+        if (row != -1) {
+            firstRow = qMin(firstRow, row);
+            lastRow = qMax(lastRow, row);
+        }
+    }
+    m_dirtyApplications.clear();
+
+    QVector<int> roles;
+    roles.swap(m_dirtyRoles);
+    std::sort(roles.begin(), roles.end());
+
+    if (lastRow != -1) {
+        Q_EMIT dataChanged(index(firstRow), index(lastRow), roles);
     }
 }
 
 void ApplicationManager::authorizeSession(const pid_t pid, bool &authorized)
 {
     // This is the only function that is called from a different thread than the one
-    // in which the object lives, that's why we use queuedAddApp
-
-    QMutexLocker locker(&m_mutex);
+    // in which the object lives, that's why we use queuedAddApp.
+    // It is called from a Mir IPC thread for every connecting client. ubuntu-app-launch is not known
+    // to be thread-safe, so its lookups are made with m_mutex held, like every other TaskController
+    // call. Only the /proc reads of the desktop_file_hint fallback are done without it, letting
+    // simultaneous connections read their credentials in parallel.
 
     tracepoint(qtmir, authorizeSession);
     authorized = false; //to be proven wrong
 
     qCDebug(QTMIR_APPLICATIONS) << "ApplicationManager::authorizeSession - pid=" << pid;
 
-    Q_FOREACH (Application *app, m_applications) {
-        if (app->state() == Application::Starting) {
-            tracepoint(qtmir, appIdHasProcessId_start);
-            if (m_taskController->appIdHasProcessId(app->appId(), pid)) {
-                authorized = true;
-                m_authorizedPids.insertMulti(pid, app->appId());
-                tracepoint(qtmir, appIdHasProcessId_end, 1); //found
-                return;
+    {
+        QMutexLocker locker(&m_mutex);
+        Q_FOREACH (Application *app, m_applications) {
+            if (app->state() == Application::Starting) {
+                tracepoint(qtmir, appIdHasProcessId_start);
+                if (m_taskController->appIdHasProcessId(app->appId(), pid)) {
+                    authorized = true;
+                    m_authorizedPids.insertMulti(pid, app->appId());
+                    app->launchTimeline().mark(LaunchTimeline::Authorized);
+                    tracepoint(qtmir, appIdHasProcessId_end, 1); //found
+                    return;
+                }
+                tracepoint(qtmir, appIdHasProcessId_end, 0); // not found
             }
-            tracepoint(qtmir, appIdHasProcessId_end, 0); // not found
         }
     }
 
@@ -542,7 +658,7 @@ void ApplicationManager::authorizeSession(const pid_t pid, bool &authorized)
      * parameter attached, or an environment variable "DESKTOP_FILE_HINT=/path/to/desktopFile.desktop".
      * This exists until all GUI applications are launched via ubuntu-app-launch.
      */
-    std::unique_ptr<ProcInfo::CommandLine> info = m_procInfo->commandLine(pid);
+    auto info = cachedCommandLine(pid);
     if (!info) {
         qWarning() << "ApplicationManager REJECTED connection from app with pid" << pid
                    << "as unable to read the process command line";
@@ -557,8 +673,8 @@ void ApplicationManager::authorizeSession(const pid_t pid, bool &authorized)
     QString desktopFileName = info->getParameter("--desktop_file_hint=");
 
     if (desktopFileName.isNull()) {
-        auto environment = m_procInfo->environment(pid);
-        if (!environment->contains("DESKTOP_FILE_HINT")) {
+        auto environment = cachedEnvironment(pid);
+        if (!environment || !environment->contains("DESKTOP_FILE_HINT")) {
             qCritical() << "ApplicationManager REJECTED connection from app with pid" << pid
                         << "as it was not launched by upstart, and no desktop_file_hint is specified";
             return;
@@ -571,6 +687,9 @@ void ApplicationManager::authorizeSession(const pid_t pid, bool &authorized)
 
     qCDebug(QTMIR_APPLICATIONS) << "Process supplied desktop_file_hint, loading:" << appId;
 
+    // Held until the end: the application list may not change between the lookup and the addition
+    QMutexLocker locker(&m_mutex);
+
     auto appInfo = m_taskController->getInfoForApp(appId);
     if (!appInfo) {
         qCritical() << "ApplicationManager REJECTED connection from app with pid" << pid
@@ -586,6 +705,7 @@ void ApplicationManager::authorizeSession(const pid_t pid, bool &authorized)
                                     << "in application list with appId:" << application->appId();
         authorized = true;
         m_authorizedPids.insertMulti(pid, appInfo->appId());
+        application->launchTimeline().mark(LaunchTimeline::Authorized);
         return;
     }
 
@@ -595,6 +715,79 @@ void ApplicationManager::authorizeSession(const pid_t pid, bool &authorized)
     m_authorizedPids.insertMulti(pid, appInfo->appId());
 }
 
+std::shared_ptr<ProcInfo::CommandLine> ApplicationManager::cachedCommandLine(const pid_t pid)
+{
+    const quint64 startTime = m_procInfo->startTime(pid);
+    {
+        QMutexLocker locker(&m_credentialsMutex);
+        auto iter = m_credentials.constFind(pid);
+        if (iter != m_credentials.constEnd() && iter->startTime == startTime && iter->commandLine
+                && !iter->age.hasExpired(credentialsLifetime)) {
+            return iter->commandLine;
+        }
+    }
+
+    // Read outside of the lock, so that connections from different processes don't wait on each other
+    std::shared_ptr<ProcInfo::CommandLine> commandLine = m_procInfo->commandLine(pid);
+    if (!commandLine) {
+        return nullptr;
+    }
+
+    QMutexLocker locker(&m_credentialsMutex);
+    CachedCredentials &credentials = cachedCredentialsMutexHeld(pid, startTime);
+    if (!credentials.commandLine) {
+        credentials.commandLine = commandLine;
+    }
+    return credentials.commandLine;
+}
+
+std::shared_ptr<ProcInfo::Environment> ApplicationManager::cachedEnvironment(const pid_t pid)
+{
+    const quint64 startTime = m_procInfo->startTime(pid);
+    {
+        QMutexLocker locker(&m_credentialsMutex);
+        auto iter = m_credentials.constFind(pid);
+        if (iter != m_credentials.constEnd() && iter->startTime == startTime && iter->environment
+                && !iter->age.hasExpired(credentialsLifetime)) {
+            return iter->environment;
+        }
+    }
+
+    std::shared_ptr<ProcInfo::Environment> environment = m_procInfo->environment(pid);
+    if (!environment) {
+        return nullptr;
+    }
+
+    QMutexLocker locker(&m_credentialsMutex);
+    CachedCredentials &credentials = cachedCredentialsMutexHeld(pid, startTime);
+    if (!credentials.environment) {
+        credentials.environment = environment;
+    }
+    return credentials.environment;
+}
+
+ApplicationManager::CachedCredentials &ApplicationManager::cachedCredentialsMutexHeld(const pid_t pid,
+                                                                                    const quint64 startTime)
+{
+    // Forget about processes which stopped connecting, so that the cache doesn't grow unbounded
+    for (auto iter = m_credentials.begin(); iter != m_credentials.end();) {
+        if (iter->age.hasExpired(credentialsLifetime)) {
+            iter = m_credentials.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    // A different start time means the pid was reused by another process
+    auto iter = m_credentials.find(pid);
+    if (iter == m_credentials.end() || iter->startTime != startTime) {
+        iter = m_credentials.insert(pid, CachedCredentials());
+        iter->startTime = startTime;
+        iter->age.start();
+    }
+    return *iter;
+}
+
 
 unityapi::ApplicationInfoInterface *ApplicationManager::findApplicationWithSurface(unityapi::MirSurfaceInterface* surface) const
 {
@@ -612,6 +805,18 @@ Application* ApplicationManager::findApplicationWithSession(const std::shared_pt
     if (!session)
         return nullptr;
 
+    if (SessionInterface *qmlSession = m_taskController->findSession(session.get())) {
+        auto application = qmlSession->application();
+        if (!application) {
+            return nullptr;
+        }
+        Application *knownApplication = m_applicationsById.value(application->appId(), nullptr);
+        if (knownApplication == application) {
+            return knownApplication;
+        }
+    }
+
+    // A session which wasn't created by the TaskController, or of a duplicate entry
     for (auto *application : m_applications) {
         for (auto *qmlSession : application->sessions()) {
             if (qmlSession->session() == session) {
@@ -636,6 +841,7 @@ void ApplicationManager::addApp(const QSharedPointer<qtmir::ApplicationInfo> &ap
         arguments,
         this);
     add(application);
+    application->launchTimeline().mark(LaunchTimeline::Authorized); // queued from authorizeSession
 }
 
 void ApplicationManager::add(Application* application)
@@ -648,6 +854,8 @@ void ApplicationManager::add(Application* application)
     }
     DEBUG_MSG << "(appId=" << application->appId() << ")";
 
+    application->setQmlCacheCleaner(m_qmlCacheCleaner);
+
     connect(application, &QObject::destroyed, this, [this, application] {
         m_closingApplications.removeAll(application);
     });
@@ -664,12 +872,18 @@ void ApplicationManager::add(Application* application)
         getting removed from the model.
      */
     // TODO: That might not be the case anymore with miral. Investigate if we can do a direct connection now
-    connect(application, &Application::focusedChanged, this, [this](bool) {
-        onAppDataChanged(RoleFocused);
+    connect(application, &Application::focusedChanged, this, [this]() {
         Q_EMIT focusedApplicationIdChanged();
     }, Qt::QueuedConnection);
 
-    connect(application, &Application::stateChanged, this, [this](Application::State) { onAppDataChanged(RoleState); });
+    // No need to queue this one, the model is only notified of it in the next event loop iteration anyway
+    connect(application, &Application::focusedChanged, this, [this, application]() {
+        onAppDataChanged(application, RoleFocused);
+    });
+
+    connect(application, &Application::stateChanged, this, [this, application](Application::State) {
+        onAppDataChanged(application, RoleState);
+    });
     connect(application, &Application::closing, this, [this, application]() { onApplicationClosing(application); });
     connect(application, &unityapi::ApplicationInfoInterface::focusRequested, this, [this, application]() {
         Q_EMIT focusRequested(application->appId());
@@ -706,6 +920,9 @@ void ApplicationManager::add(Application* application)
 
     beginInsertRows(QModelIndex(), m_applications.count(), m_applications.count());
     m_applications.append(application);
+    if (!m_applicationsById.contains(appId)) {
+        m_applicationsById.insert(appId, application);
+    }
     endInsertRows();
     Q_EMIT countChanged();
 
@@ -731,6 +948,17 @@ void ApplicationManager::remove(Application *application)
 
     beginRemoveRows(QModelIndex(), index, index);
     m_applications.removeAt(index);
+    if (m_applicationsById.value(application->appId()) == application) {
+        m_applicationsById.remove(application->appId());
+        // Another entry might have the same appId, in which case it's now the one to be found
+        for (Application *other : m_applications) {
+            if (other->appId() == application->appId()) {
+                m_applicationsById.insert(other->appId(), other);
+                break;
+            }
+        }
+    }
+    m_dirtyApplications.remove(application);
     endRemoveRows();
     Q_EMIT countChanged();
 
@@ -801,6 +1029,14 @@ void ApplicationManager::onSessionStarting(SessionInterface *qmlSession)
     if (application) {
         application->addSession(qmlSession);
     }
+
+    // PIDs are recycled, what session a PID belongs to has to be looked up again once a session comes or goes
+    m_dbusFocusInfo->invalidatePidCache();
+    connect(qmlSession, &SessionInterface::liveChanged, m_dbusFocusInfo, [this](bool live) {
+        if (!live) {
+            m_dbusFocusInfo->invalidatePidCache();
+        }
+    });
 }
 
 SessionInterface *ApplicationManager::findSession(const mir::scene::Session* session) const
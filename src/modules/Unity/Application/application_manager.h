@@ -21,11 +21,17 @@
 #include <memory>
 
 // Qt
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
 #include <QStringList>
+#include <QVector>
 
 // local
 #include "application.h"
+#include "proc_info.h"
 #include "sessionmap_interface.h"
 #include "taskcontroller.h"
 
@@ -51,8 +57,8 @@ namespace unity {
 namespace qtmir {
 
 class DBusFocusInfo;
+class QmlCacheCleaner;
 class DBusWindowStack;
-class ProcInfo;
 class SharedWakelock;
 class SettingsInterface;
 
@@ -89,6 +95,13 @@ public:
 
     SessionInterface *findSession(const mir::scene::Session* session) const override;
 
+    // Milliseconds elapsed until each LaunchTimeline stage reached by the given application
+    Q_INVOKABLE QVariantMap startupTimeline(const QString &appId) const;
+
+    // How long the last suspension and resumption of the given application took, see LifecycleLatency.
+    // Each latency is the longest among the sessions of the application.
+    Q_INVOKABLE QVariantMap lifecycleLatency(const QString &appId) const;
+
 public Q_SLOTS:
     void authorizeSession(const pid_t pid, bool &authorized);
 
@@ -101,7 +114,8 @@ public Q_SLOTS:
     void onSessionStarting(SessionInterface *session);
 
 private Q_SLOTS:
-    void onAppDataChanged(const int role);
+    void onAppDataChanged(Application *application, const int role);
+    void flushDataChanges();
     void onApplicationClosing(Application *application);
     void addApp(const QSharedPointer<qtmir::ApplicationInfo> &appInfo, const QStringList &arguments, const pid_t pid);
 
@@ -125,19 +139,44 @@ private:
     Application *findClosingApplication(const QString &inputAppId) const;
 
     QList<Application*> m_applications;
+    QHash<QString, Application*> m_applicationsById; // first entry of m_applications with each appId
     DBusFocusInfo *m_dbusFocusInfo;
     QSharedPointer<TaskController> m_taskController;
     QSharedPointer<ProcInfo> m_procInfo;
     QSharedPointer<SharedWakelock> m_sharedWakelock;
     QSharedPointer<SettingsInterface> m_settings;
+    QSharedPointer<QmlCacheCleaner> m_qmlCacheCleaner; // shared by all applications
     QList<Application*> m_closingApplications;
     QList<QString> m_queuedStartApplications;
     bool m_modelUnderChange{false};
+
+    // Role changes are coalesced until the next event loop iteration, then notified with a single
+    // dataChanged covering all the rows and roles that changed meanwhile
+    QSet<Application*> m_dirtyApplications;
+    QVector<int> m_dirtyRoles;
+    bool m_dataChangesPending{false};
     static ApplicationManager* the_application_manager;
 
     QHash<pid_t, QString> m_authorizedPids;
 
     mutable QMutex m_mutex;
+
+    // /proc contents of connecting processes, read once for all the connections a process makes
+    // during its startup. Guarded by m_credentialsMutex instead of m_mutex as it is used from Mir IPC threads.
+    // Entries are only trusted while the process with that PID is still the one they were read from.
+    struct CachedCredentials {
+        quint64 startTime{0};
+        std::shared_ptr<ProcInfo::CommandLine> commandLine;
+        std::shared_ptr<ProcInfo::Environment> environment;
+        QElapsedTimer age;
+    };
+    static const qint64 credentialsLifetime = 5000; // ms
+    std::shared_ptr<ProcInfo::CommandLine> cachedCommandLine(const pid_t pid);
+    std::shared_ptr<ProcInfo::Environment> cachedEnvironment(const pid_t pid);
+    CachedCredentials &cachedCredentialsMutexHeld(const pid_t pid, const quint64 startTime);
+
+    QHash<pid_t, CachedCredentials> m_credentials;
+    QMutex m_credentialsMutex;
 };
 
 } // namespace qtmir
@@ -18,35 +18,58 @@
 
 // QPA mirserver
 #include <logging.h>
+#include <procstat.h>
 
 #include <cgmanager/cgmanager.h>
 
 #include <QDBusArgument>
 #include <QDBusMessage>
+#include <QFile>
 
 using namespace qtmir;
 
+namespace {
+const qint64 reconnectInterval = 10000; // ms
+}
+
 // According to D-Bus interface defined in:
 // https://github.com/lxc/cgmanager/blob/master/org.linuxcontainers.cgmanager.xml
 
 CGManager::CGManager(QObject *parent)
+    : CGManager(CGMANAGER_DBUS_PATH, "/proc", "/sys/fs/cgroup", parent)
+{
+}
+
+CGManager::CGManager(const QString &peerAddress, const QString &procPath, const QString &cgroupPath,
+                     QObject *parent)
     : QObject(parent)
+    , m_peerAddress(peerAddress)
+    , m_connectionName(peerAddress == CGMANAGER_DBUS_PATH ? QStringLiteral("cgmanager")
+                                                          : QStringLiteral("cgmanager-") + peerAddress)
+    , m_procPath(procPath)
+    , m_cgroupPath(cgroupPath)
 {
 }
 
 CGManager::~CGManager()
 {
-    QDBusConnection::disconnectFromPeer("cgmanager");
+    QDBusConnection::disconnectFromPeer(m_connectionName);
 }
 
 QDBusConnection CGManager::getConnection()
 {
-    auto connection = QDBusConnection("cgmanager");
+    auto connection = QDBusConnection(m_connectionName);
 
-    if (!connection.isConnected()) {
-        connection = QDBusConnection::connectToPeer(CGMANAGER_DBUS_PATH, "cgmanager");
+    if (!connection.isConnected()
+            && (!m_lastConnectionAttempt.isValid() || m_lastConnectionAttempt.hasExpired(reconnectInterval))) {
+        m_lastConnectionAttempt.start();
+
+        // A connection that failed is kept under its name, it has to go for a new attempt to be made
+        QDBusConnection::disconnectFromPeer(m_connectionName);
+        connection = QDBusConnection::connectToPeer(m_peerAddress, m_connectionName);
         if (!connection.isConnected()) {
-            qCWarning(QTMIR_DBUS, "CGManager: Failed to connect to %s", CGMANAGER_DBUS_PATH);
+            qCWarning(QTMIR_DBUS) << "CGManager: Failed to connect to" << m_peerAddress
+                                  << "- reading cgroups from" << m_procPath << "instead";
         }
     }
 
@@ -57,7 +80,7 @@ QString CGManager::getCGroupOfPid(const QString &controller, pid_t pid)
 {
     auto connection = getConnection();
     if (!connection.isConnected()) {
-        return QString();
+        return readCGroupOfPid(controller, pid);
     }
 
     auto message = QDBusMessage::createMethodCall(QString() /*service*/, m_path, m_interface, "GetPidCgroup");
@@ -83,7 +106,7 @@ QSet<pid_t> CGManager::getTasks(const QString &controller, const QString &cgroup
 {
     auto connection = getConnection();
     if (!connection.isConnected()) {
-        return QSet<pid_t>();
+        return readTasks(controller, cgroup);
     }
 
     auto message = QDBusMessage::createMethodCall(QString() /*service*/, m_path, m_interface, "GetTasks");
@@ -115,3 +138,59 @@ QSet<pid_t> CGManager::getTasks(const QString &controller, const QString &cgroup
     }
     return pidSet;
 }
+
+quint64 CGManager::getStartTime(pid_t pid) const
+{
+    return processStartTime(pid, m_procPath);
+}
+
+QString CGManager::readCGroupOfPid(const QString &controller, pid_t pid) const
+{
+    QFile file(QStringLiteral("%1/%2/cgroup").arg(m_procPath).arg(pid));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    // One "hierarchy-id:controller[,controller...]:path" line per hierarchy.
+    // The unified hierarchy of cgroup v2 has no controller listed.
+    QString unifiedPath;
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        const int controllersStart = line.indexOf(':') + 1;
+        const int pathStart = line.indexOf(':', controllersStart) + 1;
+        if (controllersStart == 0 || pathStart == 0) {
+            continue;
+        }
+
+        const QByteArray controllers = line.mid(controllersStart, pathStart - controllersStart - 1);
+        const QString path = QString::fromUtf8(line.mid(pathStart));
+        if (controllers.isEmpty()) {
+            unifiedPath = path;
+        } else if (controllers.split(',').contains(controller.toUtf8())) {
+            return path;
+        }
+    }
+    return unifiedPath;
+}
+
+QSet<pid_t> CGManager::readTasks(const QString &controller, const QString &cgroup) const
+{
+    QFile file(m_cgroupPath + QLatin1Char('/') + controller + cgroup + QStringLiteral("/tasks"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        file.setFileName(m_cgroupPath + cgroup + QStringLiteral("/cgroup.procs"));
+        if (!file.open(QIODevice::ReadOnly)) {
+            return QSet<pid_t>();
+        }
+    }
+
+    QSet<pid_t> pidSet;
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        bool ok;
+        const pid_t pid = line.toInt(&ok);
+        if (ok) {
+            pidSet << pid;
+        }
+    }
+    return pidSet;
+}
@@ -18,23 +18,51 @@
 #define QTMIR_CGMANAGER_H
 
 #include <QDBusConnection>
+#include <QElapsedTimer>
+#include <QSet>
 
 namespace qtmir {
 
+/*
+    Queries cgroup membership of processes through cgmanager.
+
+    When cgmanager is not running, the same information is read from the cgroup file of the process
+    in /proc and from the cgroup file system instead.
+ */
 class CGManager : public QObject {
     Q_OBJECT
 public:
     CGManager(QObject *parent = nullptr);
+
+    // For tests
+    CGManager(const QString &peerAddress, const QString &procPath, const QString &cgroupPath,
+              QObject *parent = nullptr);
+
     virtual ~CGManager();
 
     QString getCGroupOfPid(const QString &controller, pid_t pid);
 
     QSet<pid_t> getTasks(const QString &controller, const QString &cgroup);
 
+    // Clock ticks since boot at which the process started, read from /proc. 0 if there is no such process.
+    // Tells a process apart from a later one that got the same pid.
+    quint64 getStartTime(pid_t pid) const;
+
 private:
     const QString m_interface{"org.linuxcontainers.cgmanager0_0"};
     const QString m_path{"/org/linuxcontainers/cgmanager"};
     QDBusConnection getConnection();
+
+    QString readCGroupOfPid(const QString &controller, pid_t pid) const;
+    QSet<pid_t> readTasks(const QString &controller, const QString &cgroup) const;
+
+    const QString m_peerAddress;
+    const QString m_connectionName;
+    const QString m_procPath;
+    const QString m_cgroupPath;
+
+    // Not trying to connect to an absent cgmanager for every query
+    QElapsedTimer m_lastConnectionAttempt;
 };
 
 } // namespace qtmir
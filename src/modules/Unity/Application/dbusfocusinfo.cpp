@@ -27,16 +27,30 @@
 #include <shelluuid.h>
 
 #include <QDBusConnection>
+#include <QDBusMetaType>
 
 using namespace qtmir;
 
-DBusFocusInfo::DBusFocusInfo(const QList<Application*> &applications)
+namespace {
+// Bounds the memory used by clients asking about lots of short-lived processes
+const int maxResolvedPids = 1024;
+}
+
+DBusFocusInfo::DBusFocusInfo(const QList<Application*> &applications, CGManager *cgManager)
     : m_applications(applications)
+    , m_cgManager(cgManager)
 {
+    qDBusRegisterMetaType<QList<uint>>();
+    qDBusRegisterMetaType<QList<bool>>();
+
     QDBusConnection::sessionBus().registerService("com.canonical.Unity.FocusInfo");
     QDBusConnection::sessionBus().registerObject("/com/canonical/Unity/FocusInfo", this, QDBusConnection::ExportScriptableSlots);
 
-    m_cgManager = new CGManager(this);
+    if (m_cgManager) {
+        m_cgManager->setParent(this);
+    } else {
+        m_cgManager = new CGManager(this);
+    }
 }
 
 bool DBusFocusInfo::isPidFocused(unsigned int pid)
@@ -46,12 +60,79 @@ bool DBusFocusInfo::isPidFocused(unsigned int pid)
         // Don't bother checking if it has a QML with activeFocus() which is not a MirSurfaceItem.
         return true;
     } else {
-        auto pidSet = fetchAssociatedPids((pid_t)pid);
-        SessionInterface *session = findSessionWithPid(pidSet);
+        SessionInterface *session = sessionWithPid((pid_t)pid);
         return session ? session->activeFocus() : false;
     }
 }
 
+QList<bool> DBusFocusInfo::arePidsFocused(const QList<uint> &pids)
+{
+    QList<bool> result;
+    result.reserve(pids.count());
+    for (uint pid : pids) {
+        result << isPidFocused(pid);
+    }
+    return result;
+}
+
+void DBusFocusInfo::invalidatePidCache()
+{
+    m_sessionsByPidValid = false;
+    m_sessionsByPid.clear();
+    m_resolvedPids.clear();
+}
+
+SessionInterface* DBusFocusInfo::sessionWithPid(pid_t pid)
+{
+    if (!m_sessionsByPidValid) {
+        auto index = [this](SessionInterface *session) {
+            if (!m_sessionsByPid.contains(session->pid())) {
+                m_sessionsByPid.insert(session->pid(), session);
+            }
+        };
+        Q_FOREACH (Application* application, m_applications) {
+            for (SessionInterface *session : application->sessions()) {
+                index(session);
+                session->foreachChildSession(index);
+            }
+        }
+        m_sessionsByPidValid = true;
+    }
+
+    auto resolved = m_resolvedPids.find(pid);
+    if (resolved != m_resolvedPids.end()) {
+        if (resolved->startTime != m_cgManager->getStartTime(pid)) {
+            // Another process got that PID since, it may well belong to another session or to none
+            m_resolvedPids.erase(resolved);
+        } else if (resolved->sessionPid == 0) {
+            return nullptr;
+        } else if (SessionInterface *session = m_sessionsByPid.value(resolved->sessionPid)) {
+            return session;
+        } else {
+            // Deleted since, start over
+            invalidatePidCache();
+            return sessionWithPid(pid);
+        }
+    }
+
+    // Before resolving, so that a process replacing this one meanwhile does not inherit the result
+    const quint64 startTime = m_cgManager->getStartTime(pid);
+    const QSet<pid_t> pidSet = fetchAssociatedPids(pid);
+    SessionInterface *session = findSessionWithPid(pidSet);
+
+    if (m_resolvedPids.count() >= maxResolvedPids) {
+        m_resolvedPids.clear();
+    }
+    // All the processes of an application cgroup belong to the same session, no need to ask about them again
+    const pid_t sessionPid = session ? session->pid() : 0;
+    for (pid_t associatedPid : pidSet) {
+        m_resolvedPids.insert(associatedPid, ResolvedPid{sessionPid, m_cgManager->getStartTime(associatedPid)});
+    }
+    m_resolvedPids.insert(pid, ResolvedPid{sessionPid, startTime});
+
+    return session;
+}
+
 QSet<pid_t> DBusFocusInfo::fetchAssociatedPids(pid_t pid)
 {
     QString cgroup = m_cgManager->getCGroupOfPid("freezer", pid);
@@ -74,21 +155,10 @@ QSet<pid_t> DBusFocusInfo::fetchAssociatedPids(pid_t pid)
 
 SessionInterface* DBusFocusInfo::findSessionWithPid(const QSet<pid_t> &pidSet)
 {
-    Q_FOREACH (Application* application, m_applications) {
-        QVector<SessionInterface*> sessions = application->sessions();
-        for (auto session : sessions) {
-            if (pidSet.contains(session->pid())) {
-                return session;
-            }
-            SessionInterface *chosenChildSession = nullptr;
-            session->foreachChildSession([&](SessionInterface* childSession) {
-                if (pidSet.contains(childSession->pid())) {
-                    chosenChildSession = childSession;
-                }
-            });
-            if (chosenChildSession) {
-                return chosenChildSession;
-            }
+    for (pid_t pid : pidSet) {
+        SessionInterface *session = m_sessionsByPid.value(pid);
+        if (session) {
+            return session;
         }
     }
     return nullptr;
@@ -14,7 +14,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QHash>
 #include <QList>
+#include <QPointer>
 #include <QSet>
 
 #include "application.h"
@@ -33,7 +35,8 @@ class DBusFocusInfo : public QObject
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "com.canonical.Unity.FocusInfo")
 public:
-    explicit DBusFocusInfo(const QList<Application*> &applications);
+    // Takes ownership of cgManager, creates its own if null
+    explicit DBusFocusInfo(const QList<Application*> &applications, CGManager *cgManager = nullptr);
     virtual ~DBusFocusInfo() {}
 
 public Q_SLOTS:
@@ -46,12 +49,23 @@ public Q_SLOTS:
      */
     Q_SCRIPTABLE bool isPidFocused(unsigned int pid);
 
+    /*
+        Same as calling isPidFocused() for each of the given PIDs, in one go
+     */
+    Q_SCRIPTABLE QList<bool> arePidsFocused(const QList<uint> &pids);
+
     /*
         Returns true if the surface with the given id has input focus
      */
     Q_SCRIPTABLE bool isSurfaceFocused(const QString &surfaceId);
 
+    /*
+        Forgets what session each PID belongs to. To be called whenever a session starts or stops.
+     */
+    void invalidatePidCache();
+
 private:
+    SessionInterface* sessionWithPid(pid_t pid);
     QSet<pid_t> fetchAssociatedPids(pid_t pid);
     SessionInterface* findSessionWithPid(const QSet<pid_t> &pidSet);
     MirSurfaceInterface *findQmlSurface(const QString &serializedId);
@@ -59,6 +73,18 @@ private:
     const QList<Application*> &m_applications;
 
     CGManager *m_cgManager;
+
+    // Every session and child session of m_applications, built on first use after being invalidated
+    QHash<pid_t, QPointer<SessionInterface>> m_sessionsByPid;
+    bool m_sessionsByPidValid{false};
+
+    // PID asked about -> PID of its session, 0 if it has none. Saves the cgmanager round-trips.
+    // Entries are only trusted while the process with that PID is still the one that was resolved.
+    struct ResolvedPid {
+        pid_t sessionPid;
+        quint64 startTime;
+    };
+    QHash<pid_t, ResolvedPid> m_resolvedPids;
 };
 
 } // namespace qtmir
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dbuslaunchinfo.h"
+
+// local
+#include "application_manager.h"
+
+#include <QDBusConnection>
+
+using namespace qtmir;
+
+DBusLaunchInfo::DBusLaunchInfo(ApplicationManager *applicationManager)
+    : QObject(applicationManager)
+    , m_applicationManager(applicationManager)
+{
+    QDBusConnection::sessionBus().registerService("com.canonical.Unity.LaunchInfo");
+    QDBusConnection::sessionBus().registerObject("/com/canonical/Unity/LaunchInfo", this, QDBusConnection::ExportScriptableSlots);
+}
+
+QVariantMap DBusLaunchInfo::startupTimeline(const QString &appId)
+{
+    return m_applicationManager->startupTimeline(appId);
+}
+
+QVariantMap DBusLaunchInfo::lifecycleLatency(const QString &appId)
+{
+    return m_applicationManager->lifecycleLatency(appId);
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_DBUSLAUNCHINFO_H
+#define QTMIR_DBUSLAUNCHINFO_H
+
+#include <QObject>
+#include <QVariantMap>
+
+namespace qtmir {
+
+class ApplicationManager;
+
+/*
+   Enables other processes, like profiling tools, to check how long the launch, suspension and resumption
+   of an application took.
+ */
+class DBusLaunchInfo : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.canonical.Unity.LaunchInfo")
+public:
+    explicit DBusLaunchInfo(ApplicationManager *applicationManager);
+    virtual ~DBusLaunchInfo() {}
+
+public Q_SLOTS:
+
+    /*
+        Milliseconds elapsed until each launch stage the application with the given id reached,
+        see LaunchTimeline. Empty if there is no such application.
+     */
+    Q_SCRIPTABLE QVariantMap startupTimeline(const QString &appId);
+
+    /*
+        Milliseconds taken by the last suspension and resumption of the application with the given id,
+        the slowest of its sessions, see LifecycleLatency. Empty if there is no such application.
+     */
+    Q_SCRIPTABLE QVariantMap lifecycleLatency(const QString &appId);
+
+private:
+    ApplicationManager *m_applicationManager;
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_DBUSLAUNCHINFO_H
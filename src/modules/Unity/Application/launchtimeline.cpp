@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "launchtimeline.h"
+
+// std
+#include <chrono>
+
+namespace qtmir {
+
+int64_t LaunchTimeline::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void LaunchTimeline::mark(Stage stage, int64_t timestamp)
+{
+    int64_t unset = 0;
+    m_timestamps[stage].compare_exchange_strong(unset, timestamp);
+}
+
+bool LaunchTimeline::reached(Stage stage) const
+{
+    return m_timestamps[stage].load() != 0;
+}
+
+void LaunchTimeline::reset()
+{
+    for (auto &timestamp : m_timestamps) {
+        timestamp.store(0);
+    }
+}
+
+int64_t LaunchTimeline::origin() const
+{
+    int64_t first = 0;
+    for (const auto &timestamp : m_timestamps) {
+        const int64_t value = timestamp.load();
+        if (value != 0 && (first == 0 || value < first)) {
+            first = value;
+        }
+    }
+    return first;
+}
+
+qreal LaunchTimeline::elapsed(Stage stage) const
+{
+    const int64_t timestamp = m_timestamps[stage].load();
+    if (timestamp == 0) {
+        return -1;
+    }
+    return (timestamp - origin()) / 1000000.0;
+}
+
+QVariantMap LaunchTimeline::toVariantMap() const
+{
+    QVariantMap timeline;
+    for (int stage = 0; stage < StageCount; ++stage) {
+        if (reached(static_cast<Stage>(stage))) {
+            timeline.insert(QString::fromLatin1(stageName(static_cast<Stage>(stage))),
+                            elapsed(static_cast<Stage>(stage)));
+        }
+    }
+    return timeline;
+}
+
+const char *LaunchTimeline::stageName(Stage stage)
+{
+    switch (stage) {
+    case Requested: return "requested";
+    case ProcessStarting: return "processStarting";
+    case Authorized: return "authorized";
+    case SessionStarted: return "sessionStarted";
+    case FirstSurface: return "firstSurface";
+    case FirstFrame: return "firstFrame";
+    case StageCount: break;
+    }
+    return "unknown";
+}
+
+} // namespace qtmir
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_LAUNCHTIMELINE_H
+#define QTMIR_LAUNCHTIMELINE_H
+
+// Qt
+#include <QVariantMap>
+
+// std
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace qtmir {
+
+/*
+  When each step of an application launch happened, from the shell asking for it to the first frame
+  drawn by the application.
+
+  Only the first time a stage is reached is kept. Stages can be marked from any thread, as sessions
+  are authorized from Mir IPC threads.
+ */
+class LaunchTimeline
+{
+public:
+    enum Stage {
+        Requested = 0,   // ApplicationManager::startApplication, unset for apps launched by someone else
+        ProcessStarting, // ubuntu-app-launch reported the process as starting
+        Authorized,      // the process first connected to Mir
+        SessionStarted,  // its first session was added to the Application
+        FirstSurface,    // its first surface was created
+        FirstFrame,      // its first surface drew its first frame
+        StageCount
+    };
+
+    static int64_t now(); // monotonic, in nanoseconds
+
+    void mark(Stage stage, int64_t timestamp = now());
+    bool reached(Stage stage) const;
+
+    // Forget all stages, for a new launch of the same application
+    void reset();
+
+    // Milliseconds elapsed from the first stage reached until the given one, -1 if not reached yet
+    qreal elapsed(Stage stage) const;
+
+    // Stage name -> elapsed(stage) for every stage reached
+    QVariantMap toVariantMap() const;
+
+    static const char *stageName(Stage stage);
+
+private:
+    int64_t origin() const;
+
+    std::array<std::atomic<int64_t>, StageCount> m_timestamps{}; // 0 if not reached
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_LAUNCHTIMELINE_H
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "lifecyclelatency.h"
+
+// std
+#include <algorithm>
+
+namespace qtmir {
+
+namespace {
+// Time given on top of the slowest recent acknowledgement, for clients that are a bit slower this time
+const qint64 acknowledgeMargin = 250;
+}
+
+void LifecycleLatency::suspendRequested(qint64 now)
+{
+    m_phase = Suspending;
+    m_suspendRequested = now;
+    m_lastFrame = -1;
+}
+
+void LifecycleLatency::suspended(qint64 now)
+{
+    if (m_phase != Suspending) {
+        return;
+    }
+    m_phase = Suspended;
+
+    m_suspendLatency = now - m_suspendRequested;
+    if (m_lastFrame == -1) {
+        // Saving its state without drawing tells nothing about how long the client needs
+        m_acknowledgeLatency = -1;
+        return;
+    }
+    m_acknowledgeLatency = m_lastFrame - m_suspendRequested;
+
+    m_acknowledgeHistory[m_historyCount % historySize] = m_acknowledgeLatency;
+    ++m_historyCount;
+}
+
+void LifecycleLatency::suspendCancelled()
+{
+    if (m_phase == Suspending) {
+        m_phase = Idle;
+    }
+}
+
+void LifecycleLatency::resumeRequested(qint64 now)
+{
+    if (m_phase != Suspended) {
+        return;
+    }
+    m_phase = Resuming;
+    m_resumeRequested = now;
+}
+
+void LifecycleLatency::framePosted(qint64 now)
+{
+    switch (m_phase) {
+    case Suspending:
+        m_lastFrame = now;
+        break;
+    case Resuming:
+        m_resumeLatency = now - m_resumeRequested;
+        m_phase = Idle;
+        break;
+    case Idle:
+    case Suspended:
+        break;
+    }
+}
+
+int LifecycleLatency::suspendTimeout() const
+{
+    if (m_historyCount == 0) {
+        return defaultSuspendTimeout;
+    }
+
+    // A client still drawing when suspended reports an acknowledgement as late as the timeout itself,
+    // which brings the timeout back up to the default next time.
+    const auto end = m_acknowledgeHistory.begin() + std::min(m_historyCount, historySize);
+    const qint64 slowest = *std::max_element(m_acknowledgeHistory.begin(), end);
+    return static_cast<int>(qBound<qint64>(minimumSuspendTimeout, 2 * slowest + acknowledgeMargin,
+                                           defaultSuspendTimeout));
+}
+
+QVariantMap LifecycleLatency::toVariantMap() const
+{
+    QVariantMap map;
+    map[QStringLiteral("acknowledge")] = m_acknowledgeLatency;
+    map[QStringLiteral("suspend")] = m_suspendLatency;
+    map[QStringLiteral("resume")] = m_resumeLatency;
+    map[QStringLiteral("suspendTimeout")] = suspendTimeout();
+    return map;
+}
+
+} // namespace qtmir
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_LIFECYCLELATENCY_H
+#define QTMIR_LIFECYCLELATENCY_H
+
+// Qt
+#include <QVariantMap>
+
+// std
+#include <array>
+
+namespace qtmir {
+
+/*
+  How long the last suspension and resumption of a session took, all times in milliseconds.
+
+  Mir clients don't acknowledge mir_lifecycle_state_will_suspend. The last frame a client posts after
+  being told is taken as its acknowledgement instead: once it stops drawing it is done getting ready.
+
+  The suspend timeout, how long a client is given between being told and being suspended, is derived
+  from how long the client took to acknowledge in its previous suspensions. Suspensions during which it
+  drew nothing are left out, the default timeout being kept for clients that never draw.
+ */
+class LifecycleLatency
+{
+public:
+    static const int defaultSuspendTimeout = 1500;
+    static const int minimumSuspendTimeout = 500;
+    static const int historySize = 8;
+
+    void suspendRequested(qint64 now);
+    void suspended(qint64 now);
+    void suspendCancelled();
+    void resumeRequested(qint64 now);
+    void framePosted(qint64 now);
+
+    // Whether framePosted() calls are of any interest right now
+    bool waitingForFrame() const { return m_phase == Suspending || m_phase == Resuming; }
+
+    // -1 until measured, the acknowledgement also when nothing was drawn during the last suspension
+    qint64 acknowledgeLatency() const { return m_acknowledgeLatency; } // suspend requested -> last frame
+    qint64 suspendLatency() const { return m_suspendLatency; }         // suspend requested -> suspended
+    qint64 resumeLatency() const { return m_resumeLatency; }           // resume requested -> first frame
+
+    int suspendTimeout() const;
+
+    QVariantMap toVariantMap() const;
+
+private:
+    enum Phase { Idle, Suspending, Suspended, Resuming };
+
+    Phase m_phase{Idle};
+    qint64 m_suspendRequested{0};
+    qint64 m_lastFrame{-1};
+    qint64 m_resumeRequested{0};
+
+    qint64 m_acknowledgeLatency{-1};
+    qint64 m_suspendLatency{-1};
+    qint64 m_resumeLatency{-1};
+
+    std::array<qint64, historySize> m_acknowledgeHistory{};
+    int m_historyCount{0};
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_LIFECYCLELATENCY_H
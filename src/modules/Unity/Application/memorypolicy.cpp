@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memorypolicy.h"
+
+// local
+#include "application.h"
+#include "application_manager.h"
+#include "mirsurfaceinterface.h"
+#include "proc_info.h"
+#include "session_interface.h"
+#include "settings_interface.h"
+
+// mirserver
+#include "logging.h"
+
+// Qt
+#include <QFile>
+
+// std
+#include <algorithm>
+#include <csignal>
+
+#define DEBUG_MSG qCDebug(QTMIR_APPLICATIONS).nospace() << "MemoryPolicy::" << __func__
+
+namespace qtmir {
+
+namespace {
+
+// Parses "avg10=<value>" out of a PSI line such as "some avg10=0.31 avg60=0.12 avg300=0.03 total=123456"
+bool parseAvg10(const QByteArray &line, qreal &value)
+{
+    static const QByteArray key("avg10=");
+    const int start = line.indexOf(key);
+    if (start < 0) {
+        return false;
+    }
+    const int valueStart = start + key.size();
+    const int end = line.indexOf(' ', valueStart);
+
+    bool ok;
+    value = line.mid(valueStart, end < 0 ? -1 : end - valueStart).toDouble(&ok);
+    return ok;
+}
+
+// Settings are read through QGSettings, which turns "memory-policy-enabled" into "memoryPolicyEnabled"
+const QString enabledKey = QStringLiteral("memoryPolicyEnabled");
+const QString suspendPressureKey = QStringLiteral("memoryPolicySuspendPressure");
+const QString terminatePressureKey = QStringLiteral("memoryPolicyTerminatePressure");
+const QString backgroundMemoryLimitKey = QStringLiteral("memoryPolicyBackgroundMemoryLimit");
+const QString cooldownKey = QStringLiteral("memoryPolicyCooldown");
+
+} // anonymous namespace
+
+ProcMemoryPressureSource::ProcMemoryPressureSource(const QString &path)
+    : m_path(path)
+{
+}
+
+bool ProcMemoryPressureSource::read(MemoryPressure &pressure)
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    bool haveSome = false;
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("some ")) {
+            haveSome = parseAvg10(line, pressure.some);
+        } else if (line.startsWith("full ")) {
+            parseAvg10(line, pressure.full);
+        }
+    }
+    return haveSome;
+}
+
+MemoryPolicy::MemoryPolicy(ApplicationManager *applicationManager,
+                           const QSharedPointer<MemoryPressureSource> &pressureSource,
+                           const QSharedPointer<ProcInfo> &procInfo,
+                           const QSharedPointer<SettingsInterface> &settings,
+                           QObject *parent)
+    : QObject(parent)
+    , m_applicationManager(applicationManager)
+    , m_pressureSource(pressureSource)
+    , m_procInfo(procInfo)
+    , m_settings(settings)
+    , m_timeSource(new RealTimeSource)
+{
+    connect(m_applicationManager, &ApplicationManager::focusedApplicationIdChanged,
+            this, &MemoryPolicy::onFocusedApplicationIdChanged);
+    connect(&m_timer, &QTimer::timeout, this, &MemoryPolicy::evaluate);
+
+    if (m_settings) {
+        connect(m_settings.data(), &SettingsInterface::changed, this, &MemoryPolicy::onSettingChanged);
+    }
+    readSettings();
+}
+
+void MemoryPolicy::start(int intervalMs)
+{
+    m_intervalMs = intervalMs;
+    updateTimer();
+}
+
+void MemoryPolicy::onSettingChanged(const QString &key)
+{
+    if (key.startsWith(QStringLiteral("memoryPolicy"))) {
+        readSettings();
+        updateTimer();
+    }
+}
+
+void MemoryPolicy::readSettings()
+{
+    if (!m_settings) {
+        return;
+    }
+
+    // Keep the defaults for settings missing from an older schema
+    bool ok;
+    const QVariant enabled = m_settings->get(enabledKey);
+    m_enabled = enabled.type() == QVariant::Bool && enabled.toBool();
+
+    const qreal suspendPressure = m_settings->get(suspendPressureKey).toDouble(&ok);
+    if (ok) m_thresholds.suspendPressure = suspendPressure;
+
+    const qreal terminatePressure = m_settings->get(terminatePressureKey).toDouble(&ok);
+    if (ok) m_thresholds.terminatePressure = terminatePressure;
+
+    const qint64 backgroundMemoryLimit = m_settings->get(backgroundMemoryLimitKey).toLongLong(&ok);
+    if (ok) m_thresholds.backgroundMemoryLimit = backgroundMemoryLimit;
+
+    const int cooldown = m_settings->get(cooldownKey).toInt(&ok);
+    if (ok) m_thresholds.cooldownMs = cooldown;
+}
+
+void MemoryPolicy::updateTimer()
+{
+    if (m_enabled && m_intervalMs > 0) {
+        DEBUG_MSG << "() - evaluating every " << m_intervalMs << "ms";
+        m_timer.start(m_intervalMs);
+    } else {
+        m_timer.stop();
+    }
+}
+
+void MemoryPolicy::onFocusedApplicationIdChanged()
+{
+    const QString appId = m_applicationManager->focusedApplicationId();
+    if (appId.isEmpty()) {
+        return;
+    }
+
+    m_lastUse[appId] = ++m_useCount;
+
+    if (m_suspendedByPolicy.remove(appId)) {
+        if (Application *application = m_applicationManager->findApplication(appId)) {
+            DEBUG_MSG << "() - resuming " << appId;
+            application->setRequestedState(Application::RequestedRunning);
+        }
+    }
+}
+
+Application *MemoryPolicy::evaluate()
+{
+    if (isCoolingDown()) {
+        return nullptr;
+    }
+
+    MemoryPressure pressure;
+    const bool pressureKnown = m_pressureSource->read(pressure);
+
+    const QList<Application*> candidates = backgroundApplications();
+
+    if (pressureKnown && pressure.full >= m_thresholds.terminatePressure) {
+        for (Application *application : candidates) {
+            if (canTerminate(application)) {
+                DEBUG_MSG << "() - full memory pressure " << pressure.full << "%, terminating " << application->appId();
+                terminate(application);
+                m_lastActionTime = m_timeSource->msecsSinceReference();
+                return application;
+            }
+        }
+    }
+
+    if (pressureKnown && pressure.some >= m_thresholds.suspendPressure) {
+        for (Application *application : candidates) {
+            if (canSuspend(application)) {
+                DEBUG_MSG << "() - memory pressure " << pressure.some << "%, suspending " << application->appId();
+                suspend(application);
+                m_lastActionTime = m_timeSource->msecsSinceReference();
+                return application;
+            }
+        }
+    }
+
+    if (m_thresholds.backgroundMemoryLimit > 0) {
+        for (Application *application : candidates) {
+            if (canSuspend(application) && residentMemory(application) > m_thresholds.backgroundMemoryLimit) {
+                DEBUG_MSG << "() - " << application->appId() << " uses too much memory, suspending it";
+                suspend(application);
+                m_lastActionTime = m_timeSource->msecsSinceReference();
+                return application;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+bool MemoryPolicy::isCoolingDown()
+{
+    return m_lastActionTime >= 0
+        && m_timeSource->msecsSinceReference() - m_lastActionTime < m_thresholds.cooldownMs;
+}
+
+
+QList<Application*> MemoryPolicy::backgroundApplications()
+{
+    QList<Application*> applications;
+    QSet<pid_t> livePids;
+
+    const int count = m_applicationManager->rowCount();
+    for (int i = 0; i < count; ++i) {
+        Application *application = m_applicationManager->get(i);
+        if (!application) {
+            continue;
+        }
+        for (SessionInterface *session : application->sessions()) {
+            livePids.insert(session->pid());
+        }
+        if (!application->focused() && !isExempt(application) && !isVisible(application)) {
+            applications << application;
+        }
+    }
+
+    // Their pids might get reused
+    m_terminatedPids.intersect(livePids);
+
+    std::stable_sort(applications.begin(), applications.end(), [this](Application *a, Application *b) {
+        return m_lastUse.value(a->appId()) < m_lastUse.value(b->appId());
+    });
+    return applications;
+}
+
+bool MemoryPolicy::isExempt(Application *application) const
+{
+    if (application->exemptFromLifecycle()) {
+        return true;
+    }
+    return m_settings
+        && m_settings->get(QStringLiteral("lifecycleExemptAppids")).toStringList().contains(application->appId());
+}
+
+bool MemoryPolicy::isVisible(Application *application) const
+{
+    // eg. an unfocused window still on display on a desktop
+    auto surfaceList = application->surfaceList();
+    for (int i = 0; i < surfaceList->count(); ++i) {
+        auto surface = static_cast<const MirSurfaceInterface*>(surfaceList->get(i));
+        if (surface->isBeingDisplayed()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MemoryPolicy::canSuspend(Application *application) const
+{
+    return application->internalState() == Application::InternalState::Running
+        && application->processState() == Application::ProcessRunning
+        && application->requestedState() == Application::RequestedRunning;
+}
+
+bool MemoryPolicy::canTerminate(Application *application) const
+{
+    if (application->internalState() != Application::InternalState::Suspended) {
+        return false;
+    }
+
+    const QVector<SessionInterface*> sessions = application->sessions();
+    if (sessions.isEmpty()) {
+        return false;
+    }
+    for (SessionInterface *session : sessions) {
+        if (m_terminatedPids.contains(session->pid())) {
+            return false; // already on its way out
+        }
+    }
+    return true;
+}
+
+qint64 MemoryPolicy::residentMemory(Application *application) const
+{
+    qint64 total = 0;
+    for (SessionInterface *session : application->sessions()) {
+        total += std::max<qint64>(0, m_procInfo->residentMemory(session->pid()));
+    }
+    return total;
+}
+
+// Not Application::suspend(): the application state machine applies the requested state again on every session
+// change, so it would resume the application right away. canSuspend() makes sure the requested state was running.
+void MemoryPolicy::suspend(Application *application)
+{
+    m_suspendedByPolicy.insert(application->appId());
+    application->setRequestedState(Application::RequestedSuspended);
+}
+
+// Not Application::terminate(): the process is stopped, a SIGTERM would only be delivered once resumed
+void MemoryPolicy::terminate(Application *application)
+{
+    for (SessionInterface *session : application->sessions()) {
+        m_terminatedPids.insert(session->pid());
+        kill(session->pid(), SIGKILL);
+    }
+}
+
+} // namespace qtmir
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_MEMORYPOLICY_H
+#define QTMIR_MEMORYPOLICY_H
+
+// Qt
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QTimer>
+
+// local
+#include "timesource.h"
+
+namespace qtmir {
+
+class Application;
+class ApplicationManager;
+class ProcInfo;
+class SettingsInterface;
+
+/*
+  Share of time, in percent over the last 10 seconds, during which some or all tasks were stalled
+  waiting for memory. See Documentation/accounting/psi.txt in the kernel sources.
+ */
+struct MemoryPressure
+{
+    qreal some{0};
+    qreal full{0};
+};
+
+class MemoryPressureSource
+{
+public:
+    virtual ~MemoryPressureSource() = default;
+
+    // False if memory pressure is unknown, eg. the kernel doesn't support PSI
+    virtual bool read(MemoryPressure &pressure) = 0;
+};
+
+class ProcMemoryPressureSource : public MemoryPressureSource
+{
+public:
+    explicit ProcMemoryPressureSource(const QString &path = QStringLiteral("/proc/pressure/memory"));
+
+    bool read(MemoryPressure &pressure) override;
+
+private:
+    const QString m_path;
+};
+
+/*
+  Frees memory when the system runs short of it, by suspending and then terminating the applications
+  in the background, least recently used first.
+
+  Applications are suspended the same way the shell would do it, by requesting them to be suspended,
+  and get their requested state back to running as soon as they get focused again. Only applications
+  whose requested state is running are suspended, so the shell's own requests are never overridden.
+  Only suspended applications are terminated, killed as the OOM killer would, so that they end up
+  stopped but resumable. A running one whose process goes away is considered gone for good.
+  Applications exempt from the lifecycle and those with a surface on display are left alone.
+
+  Memory pressure is a 10 seconds average, so after acting the policy waits for it to reflect the
+  memory freed before acting again. Otherwise it would go on until no background application is left.
+
+  Disabled unless the memory-policy-enabled setting is set, thresholds come from the settings too.
+ */
+class MemoryPolicy : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Thresholds {
+        qreal suspendPressure{10};   // "some" pressure above which background applications get suspended
+        qreal terminatePressure{5};  // "full" pressure above which background applications get terminated
+        qint64 backgroundMemoryLimit{0}; // bytes, background applications using more get suspended. 0 for no limit
+        int cooldownMs{10000};       // after an application is suspended or terminated. At least the averaging window
+    };
+
+    MemoryPolicy(ApplicationManager *applicationManager,
+                 const QSharedPointer<MemoryPressureSource> &pressureSource,
+                 const QSharedPointer<ProcInfo> &procInfo,
+                 const QSharedPointer<SettingsInterface> &settings,
+                 QObject *parent = nullptr);
+
+    Thresholds thresholds() const { return m_thresholds; }
+    void setThresholds(const Thresholds &thresholds) { m_thresholds = thresholds; }
+
+    void setTimeSource(const SharedTimeSource &timeSource) { m_timeSource = timeSource; }
+
+    bool isEnabled() const { return m_enabled; }
+
+    // Evaluates the policy periodically, while enabled in the settings
+    void start(int intervalMs = 1000);
+
+    // Suspends or terminates at most one application, then nothing until the cooldown is over, giving
+    // the system time to reflect it in the memory pressure. Returns the application acted upon, if any.
+    Application *evaluate();
+
+private Q_SLOTS:
+    void onFocusedApplicationIdChanged();
+    void onSettingChanged(const QString &key);
+
+private:
+    QList<Application*> backgroundApplications(); // least recently used first
+    void readSettings();
+    void updateTimer();
+    bool isExempt(Application *application) const;
+    bool isVisible(Application *application) const;
+    bool isCoolingDown();
+    bool canSuspend(Application *application) const;
+    bool canTerminate(Application *application) const;
+    qint64 residentMemory(Application *application) const;
+    void suspend(Application *application);
+    void terminate(Application *application);
+
+    ApplicationManager *m_applicationManager;
+    QSharedPointer<MemoryPressureSource> m_pressureSource;
+    QSharedPointer<ProcInfo> m_procInfo;
+    QSharedPointer<SettingsInterface> m_settings;
+    SharedTimeSource m_timeSource;
+    Thresholds m_thresholds;
+    bool m_enabled{false};
+    int m_intervalMs{0};
+    QTimer m_timer;
+    qint64 m_lastActionTime{-1}; // msecs, -1 if never acted
+
+    quint64 m_useCount{0};
+    QHash<QString, quint64> m_lastUse; // appId -> m_useCount when it was last focused
+    QSet<QString> m_suspendedByPolicy;
+    QSet<pid_t> m_terminatedPids;
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_MEMORYPOLICY_H
@@ -159,7 +159,7 @@ MirSurface::MirSurface(NewWindow newWindowInfo,
 
     m_position = convertDisplayToLocalCoords(toQPoint(m_window.top_left()));
 
-    SurfaceObserver::registerObserverForSurface(m_surfaceObserver.get(), m_surface.get());
+    SurfaceObserver::registerObserverForSurface(m_surfaceObserver, m_surface.get());
     m_surface->add_observer(m_surfaceObserver);
 
     connect(m_surfaceObserver.get(), &SurfaceObserver::framesPosted, this, &MirSurface::onFramesPostedObserved);
@@ -175,7 +175,7 @@ MirSurface::MirSurface(NewWindow newWindowInfo,
     connect(m_surfaceObserver.get(), &SurfaceObserver::shellChromeChanged, this, [&](MirShellChrome shell_chrome) {
         setShellChrome(toQtShellChrome(shell_chrome));
     });
-    connect(m_surfaceObserver.get(), &SurfaceObserver::inputBoundsChanged, this, &MirSurface::setInputBounds);
+    connect(m_surfaceObserver.get(), &SurfaceObserver::inputShapeChanged, this, &MirSurface::setInputShape);
     connect(m_surfaceObserver.get(), &SurfaceObserver::confinesMousePointerChanged, this, &MirSurface::confinesMousePointerChanged);
     m_surfaceObserver->setListener(this);
 
@@ -882,13 +882,13 @@ bool MirSurface::inputAreaContains(const QPoint &point) const
 
 
     // Can't use it due to https://bugs.launchpad.net/mir/+bug/1598936
-    // FIXME: Use the line below instead of m_inputBounds once this bug gets fixed.
+    // FIXME: Use the line below instead of m_inputShape once this bug gets fixed.
     //result = m_surface->input_area_contains(mir::geometry::Point(point.x(), point.y()));
 
-    if (m_inputBounds.isNull()) {
+    if (m_inputShape.isEmpty()) {
         result = true;
     } else {
-        result = m_inputBounds.contains(point);
+        result = m_inputShape.contains(point);
     }
 
     return result;
@@ -999,11 +999,17 @@ std::shared_ptr<SurfaceObserver> MirSurface::surfaceObserver() const
     return m_surfaceObserver;
 }
 
-void MirSurface::setInputBounds(const QRect &rect)
+void MirSurface::setInputShape(const QVector<QRect> &rects)
 {
-    if (m_inputBounds != rect) {
-        DEBUG_MSG << "(" << rect << ")";
-        m_inputBounds = rect;
+    RectRegion inputShape(rects);
+    if (m_inputShape == inputShape) {
+        return;
+    }
+    DEBUG_MSG << "(" << rects << ")";
+    m_inputShape = inputShape;
+
+    if (m_inputBounds != m_inputShape.boundingRect()) {
+        m_inputBounds = m_inputShape.boundingRect();
         Q_EMIT inputBoundsChanged(m_inputBounds);
     }
 }
@@ -33,6 +33,7 @@
 #include <QKeyEvent>
 
 #include "mirbuffersgtexture.h"
+#include "rectregion.h"
 #include "windowcontrollerinterface.h"
 #include "windowmodelnotifier.h"
 
@@ -193,7 +194,7 @@ private Q_SLOTS:
     void onFramesPostedObserved();
     void emitSizeChanged();
     void setCursor(const QCursor &cursor);
-    void setInputBounds(const QRect &rect);
+    void setInputShape(const QVector<QRect> &rects);
 
 private:
     void syncSurfaceSizeWithItemSize();
@@ -270,6 +271,7 @@ private:
     Mir::ShellChrome m_shellChrome;
 
     QRect m_inputBounds;
+    RectRegion m_inputShape; // what m_inputBounds is the bounding rect of
 
     bool m_focused{false};
 
@@ -22,10 +22,101 @@
 
 #include <QDebug>
 #include <QDebugStateSaver>
+#include <QHash>
+#include <QSet>
 
 namespace unityapp = unity::shell::application;
 using namespace qtmir;
 
+namespace qtmir {
+
+/*
+  Keeps track of which MirSurfaceListModels contain each surface, so that a surface is connected to
+  only once no matter how many lists (a session's, its application's, its parent prompt session's...)
+  contain it.
+ */
+class MirSurfaceListWatcher
+{
+public:
+    static MirSurfaceListWatcher *instance()
+    {
+        // never deleted, lists may outlive any static
+        static MirSurfaceListWatcher *watcher = new MirSurfaceListWatcher;
+        return watcher;
+    }
+
+    void watch(MirSurfaceInterface *surface, MirSurfaceListModel *list)
+    {
+        Watch &watch = m_watches[surface];
+        if (watch.lists.isEmpty()) {
+            watch.focusedChanged = QObject::connect(surface, &MirSurfaceInterface::focusedChanged,
+                [this, surface](bool focused) {
+                    if (focused) {
+                        forEachList(surface, [surface](MirSurfaceListModel *list) { list->raise(surface); });
+                    }
+                });
+            watch.destroyed = QObject::connect(surface, &QObject::destroyed,
+                [this, surface]() {
+                    forEachList(surface, [surface](MirSurfaceListModel *list) { list->removeSurface(surface); });
+                    forget(surface);
+                });
+        }
+        watch.lists.append(list);
+    }
+
+    void unwatch(MirSurfaceInterface *surface, MirSurfaceListModel *list)
+    {
+        auto it = m_watches.find(surface);
+        if (it == m_watches.end()) {
+            return;
+        }
+        it->lists.removeOne(list);
+        if (it->lists.isEmpty()) {
+            forget(surface);
+        }
+    }
+
+    bool isWatching(MirSurfaceInterface *surface, const MirSurfaceListModel *list) const
+    {
+        auto it = m_watches.constFind(surface);
+        return it != m_watches.constEnd()
+            && it->lists.contains(const_cast<MirSurfaceListModel*>(list));
+    }
+
+private:
+    struct Watch {
+        QList<MirSurfaceListModel*> lists;
+        QMetaObject::Connection focusedChanged;
+        QMetaObject::Connection destroyed;
+    };
+
+    template<typename F>
+    void forEachList(MirSurfaceInterface *surface, F f)
+    {
+        // lists may be changed by f, eg. an aggregate list removes a surface when its source list does
+        const QList<MirSurfaceListModel*> lists = m_watches.value(surface).lists;
+        for (MirSurfaceListModel *list : lists) {
+            if (isWatching(surface, list)) {
+                f(list);
+            }
+        }
+    }
+
+    void forget(MirSurfaceInterface *surface)
+    {
+        auto it = m_watches.find(surface);
+        if (it != m_watches.end()) {
+            QObject::disconnect(it->focusedChanged);
+            QObject::disconnect(it->destroyed);
+            m_watches.erase(it);
+        }
+    }
+
+    QHash<MirSurfaceInterface*, Watch> m_watches;
+};
+
+} // namespace qtmir
+
 MirSurfaceListModel::MirSurfaceListModel(QObject *parent) :
     MirSurfaceListInterface(parent)
 {
@@ -34,6 +125,10 @@ MirSurfaceListModel::MirSurfaceListModel(QObject *parent) :
 MirSurfaceListModel::~MirSurfaceListModel()
 {
     Q_EMIT destroyed(this); // Early warning, while MirSurfaceListModel methods can still be accessed.
+
+    for (MirSurfaceInterface *surface : m_surfaceList) {
+        MirSurfaceListWatcher::instance()->unwatch(surface, this);
+    }
 }
 
 int MirSurfaceListModel::rowCount(const QModelIndex &parent) const
@@ -66,7 +161,7 @@ void MirSurfaceListModel::prependSurface(MirSurfaceInterface *surface)
 {
     beginInsertRows(QModelIndex(), 0/*first*/, 0/*last*/);
     m_surfaceList.prepend(surface);
-    connectSurface(surface);
+    MirSurfaceListWatcher::instance()->watch(surface, this);
     endInsertRows();
     Q_EMIT countChanged(m_surfaceList.count());
     if (count() == 1) {
@@ -75,30 +170,53 @@ void MirSurfaceListModel::prependSurface(MirSurfaceInterface *surface)
     Q_EMIT firstChanged();
 }
 
-void MirSurfaceListModel::connectSurface(MirSurfaceInterface *surface)
+void MirSurfaceListModel::removeSurface(MirSurfaceInterface *surface)
 {
-    connect(surface, &MirSurfaceInterface::focusedChanged, this, [this, surface](bool focused){
-        if (focused) {
-            this->raise(surface);
-        }
-    });
-    connect(surface, &QObject::destroyed, this, [this, surface](){ this->removeSurface(surface); });
+    removeSurfaces(QList<MirSurfaceInterface*>() << surface);
 }
 
-void MirSurfaceListModel::removeSurface(MirSurfaceInterface *surface)
+void MirSurfaceListModel::removeSurfaces(const QList<MirSurfaceInterface*> &surfaces)
 {
-    int i = m_surfaceList.indexOf(surface);
-    if (i != -1) {
-        beginRemoveRows(QModelIndex(), i, i);
-        m_surfaceList.removeAt(i);
-        endRemoveRows();
-        Q_EMIT countChanged(m_surfaceList.count());
-        if (count() == 0) {
-            Q_EMIT emptyChanged();
+    QSet<MirSurfaceInterface*> toRemove;
+    for (MirSurfaceInterface *surface : surfaces) {
+        if (contains(surface)) {
+            toRemove.insert(surface);
         }
-        if (i == 0) {
-            Q_EMIT firstChanged();
+    }
+    if (toRemove.isEmpty()) {
+        return;
+    }
+
+    const bool firstRemoved = toRemove.contains(m_surfaceList.first());
+
+    // From the bottom up, one block of contiguous rows at a time
+    int last = m_surfaceList.count() - 1;
+    while (last >= 0) {
+        if (!toRemove.contains(m_surfaceList.at(last))) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && toRemove.contains(m_surfaceList.at(first - 1))) {
+            --first;
         }
+
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int i = first; i <= last; ++i) {
+            MirSurfaceListWatcher::instance()->unwatch(m_surfaceList.at(i), this);
+        }
+        m_surfaceList.erase(m_surfaceList.begin() + first, m_surfaceList.begin() + last + 1);
+        endRemoveRows();
+
+        last = first - 1;
+    }
+
+    Q_EMIT countChanged(m_surfaceList.count());
+    if (count() == 0) {
+        Q_EMIT emptyChanged();
+    }
+    if (firstRemoved) {
+        Q_EMIT firstChanged();
     }
 }
 
@@ -147,13 +265,7 @@ void MirSurfaceListModel::prependSurfaces(const QList<MirSurfaceInterface*> &sur
     for (int i = prependLast; i >= prependFirst; --i) {
         auto surface = surfaceList.at(i);
         m_surfaceList.prepend(surface);
-        connect(surface, &MirSurfaceInterface::focusedChanged, this,
-                [this, surface](bool focused)
-                {
-                    if (focused) {
-                        this->raise(surface);
-                    }
-                });
+        MirSurfaceListWatcher::instance()->watch(surface, this);
     }
     endInsertRows();
     Q_EMIT countChanged(m_surfaceList.count());
@@ -180,9 +292,7 @@ void MirSurfaceListModel::addSurfaceList(MirSurfaceListModel *surfaceListModel)
     connect(surfaceListModel, &QAbstractItemModel::rowsAboutToBeRemoved, this,
             [this, surfaceListModel](const QModelIndex & /*parent*/, int first, int last)
             {
-                for (int i = first; i <= last; ++i) {
-                    this->removeSurface(surfaceListModel->m_surfaceList[i]);
-                }
+                this->removeSurfaces(surfaceListModel->m_surfaceList.mid(first, last - first + 1));
             });
 
     connect(surfaceListModel, &QObject::destroyed, this,
@@ -202,9 +312,12 @@ void MirSurfaceListModel::removeSurfaceList(MirSurfaceListModel *surfaceListMode
 
     disconnect(surfaceListModel, 0, this, 0);
 
-    for (int i = 0; i < surfaceListModel->m_surfaceList.count(); ++i) {
-        removeSurface(surfaceListModel->m_surfaceList[i]);
-    }
+    removeSurfaces(surfaceListModel->m_surfaceList);
+}
+
+bool MirSurfaceListModel::contains(MirSurfaceInterface *surface) const
+{
+    return MirSurfaceListWatcher::instance()->isWatching(surface, this);
 }
 
 bool MirSurfaceListModel::isEmpty() const
@@ -27,6 +27,7 @@ namespace qtmir {
 
 class MirSurfaceInterface;
 class CombinedSurfaceListModel;
+class MirSurfaceListWatcher;
 
 /*
    A list model of MirSurfaces
@@ -35,6 +36,9 @@ class CombinedSurfaceListModel;
 
    It's possible combine several list models into a new, separate, one which will track
    changes done to those original models and reflect them appropriately.
+
+   Surfaces are watched for focus changes and destruction with a single set of connections,
+   however many lists contain them.
  */
 class MirSurfaceListModel : public unity::shell::application::MirSurfaceListInterface
 {
@@ -52,12 +56,13 @@ public:
 
     void prependSurface(MirSurfaceInterface *surface);
     void removeSurface(MirSurfaceInterface *surface);
+    void removeSurfaces(const QList<MirSurfaceInterface*> &surfaces);
 
     // Added surface list models will be tracked for later additions and removals
     void addSurfaceList(MirSurfaceListModel *surfaceList);
     void removeSurfaceList(MirSurfaceListModel *surfaceList);
 
-    bool contains(MirSurfaceInterface *surface) const { return m_surfaceList.contains(surface); }
+    bool contains(MirSurfaceInterface *surface) const;
 
     bool isEmpty() const;
 
@@ -67,11 +72,12 @@ Q_SIGNALS:
 private:
     void raise(MirSurfaceInterface *surface);
     void moveSurface(int from, int to);
-    void connectSurface(MirSurfaceInterface *surface);
     void prependSurfaces(const QList<MirSurfaceInterface *> &surfaceList, int prependFirst, int prependLast);
 
     QList<MirSurfaceInterface*> m_surfaceList;
     QList<MirSurfaceListModel*> m_trackedModels;
+
+    friend class MirSurfaceListWatcher;
 };
 
 /*
@@ -19,9 +19,20 @@
 
 // Qt
 #include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
+
+// std
+#include <algorithm>
 
 namespace qtmir {
 
+/*
+  List model of object pointers, each appearing at most once.
+
+  The row of every item is kept in a hash, so that lookups are O(1). Batch operations emit a single
+  begin/end pair per contiguous block of rows affected rather than one per item.
+ */
 template<class TYPE>
 class ObjectListModel : public QAbstractListModel
 {
@@ -35,32 +46,116 @@ public:
     };
 
     const QList<TYPE*>& list() const { return m_items; }
-    bool contains(TYPE* item) const { return m_items.contains(item); }
+    bool contains(TYPE* item) const { return m_rows.contains(item); }
+    int indexOf(TYPE* item) const { return m_rows.value(item, -1); }
 
     void insert(uint index, TYPE* item)
     {
         index = qMin(index, (uint)m_items.count());
 
-        int existingIndex = m_items.indexOf(item);
+        int existingIndex = indexOf(item);
         if (existingIndex != -1) {
             move(existingIndex, qMin(index, (uint)(m_items.count()-1)));
         } else {
             beginInsertRows(QModelIndex(), index, index);
             m_items.insert(index, item);
+            updateRows(index, m_items.count() - 1);
             endInsertRows();
         }
     }
 
+    // Inserts the given items as one block at index. Items already in the model are left where they are.
+    void insert(uint index, const QList<TYPE*> &items)
+    {
+        index = qMin(index, (uint)m_items.count());
+
+        QList<TYPE*> newItems;
+        QSet<TYPE*> seen;
+        for (TYPE *item : items) {
+            if (!contains(item) && !seen.contains(item)) {
+                seen.insert(item);
+                newItems.append(item);
+            }
+        }
+        if (newItems.isEmpty()) {
+            return;
+        }
+
+        beginInsertRows(QModelIndex(), index, index + newItems.count() - 1);
+        m_items.reserve(m_items.count() + newItems.count());
+        QList<TYPE*> tail = m_items.mid(index);
+        m_items.erase(m_items.begin() + index, m_items.end());
+        m_items.append(newItems);
+        m_items.append(tail);
+        updateRows(index, m_items.count() - 1);
+        endInsertRows();
+    }
+
     void remove(TYPE* item)
     {
-        int existingIndex = m_items.indexOf(item);
+        int existingIndex = indexOf(item);
         if (existingIndex != -1) {
             beginRemoveRows(QModelIndex(), existingIndex, existingIndex);
             m_items.removeAt(existingIndex);
+            m_rows.remove(item);
+            updateRows(existingIndex, m_items.count() - 1);
             endRemoveRows();
         }
     }
 
+    // Removes the given items, one block of contiguous rows at a time. Items not in the model are ignored.
+    void remove(const QList<TYPE*> &items)
+    {
+        QVector<int> rows;
+        rows.reserve(items.count());
+        for (TYPE *item : items) {
+            int existingIndex = indexOf(item);
+            if (existingIndex != -1) {
+                rows.append(existingIndex);
+            }
+        }
+        if (rows.isEmpty()) {
+            return;
+        }
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+        // from the bottom up, so that the rows above stay valid
+        int last = rows.count() - 1;
+        while (last >= 0) {
+            int first = last;
+            while (first > 0 && rows[first - 1] == rows[first] - 1) {
+                --first;
+            }
+
+            beginRemoveRows(QModelIndex(), rows[first], rows[last]);
+            for (int row = rows[first]; row <= rows[last]; ++row) {
+                m_rows.remove(m_items.at(row));
+            }
+            m_items.erase(m_items.begin() + rows[first], m_items.begin() + rows[last] + 1);
+            updateRows(rows[first], m_items.count() - 1);
+            endRemoveRows();
+
+            last = first - 1;
+        }
+    }
+
+    // Replaces the whole content of the model at once
+    void reset(const QList<TYPE*> &items)
+    {
+        beginResetModel();
+        m_items.clear();
+        m_rows.clear();
+        m_items.reserve(items.count());
+        for (TYPE *item : items) {
+            if (!m_rows.contains(item)) {
+                m_rows.insert(item, m_items.count());
+                m_items.append(item);
+            }
+        }
+        endResetModel();
+    }
+
     // from QAbstractItemModel
     int rowCount(const QModelIndex& = QModelIndex()) const override
     {
@@ -88,21 +183,44 @@ public:
 protected:
     void move(int from, int to)
     {
-        if (from == to) return;
+        move(from, from, to);
+    }
+
+    // Moves the rows first..last so that the first of them ends up at row to
+    void move(int first, int last, int to)
+    {
+        const int count = last - first + 1;
+        if (first == to || count <= 0) return;
 
-        if (from >= 0 && from < m_items.size() && to >= 0 && to < m_items.size()) {
+        if (first >= 0 && last < m_items.size() && to >= 0 && to + count <= m_items.size()) {
             QModelIndex parent;
-            /* When moving an item down, the destination index needs to be incremented
-               by one, as explained in the documentation:
+            /* When moving items down, the destination index needs to be past the moved block,
+               as explained in the documentation:
                http://qt-project.org/doc/qt-5.0/qtcore/qabstractitemmodel.html#beginMoveRows */
 
-            beginMoveRows(parent, from, from, parent, to + (to > from ? 1 : 0));
-            m_items.move(from, to);
+            beginMoveRows(parent, first, last, parent, to > first ? to + count : to);
+            if (to > first) {
+                std::rotate(m_items.begin() + first, m_items.begin() + last + 1, m_items.begin() + to + count);
+                updateRows(first, to + count - 1);
+            } else {
+                std::rotate(m_items.begin() + to, m_items.begin() + first, m_items.begin() + last + 1);
+                updateRows(to, last);
+            }
             endMoveRows();
         }
     }
 
     QList<TYPE*> m_items;
+
+private:
+    void updateRows(int first, int last)
+    {
+        for (int row = first; row <= last; ++row) {
+            m_rows[m_items.at(row)] = row;
+        }
+    }
+
+    QHash<TYPE*, int> m_rows;
 };
 
 } // namespace qtmir
@@ -15,27 +15,106 @@
  */
 
 #include "proc_info.h"
+#include "procstat.h"
+
+// std
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 
 // Qt
-#include <QFile>
-#include <QRegularExpression>
+#include <QString>
 
 namespace qtmir
 {
 
+namespace {
+
+// Calls visit(entry, length) on every entry of a NUL separated list until it returns true
+template<typename Visitor>
+bool findEntry(const QByteArray &list, Visitor visit)
+{
+    const char *entry = list.constData();
+    const char *const end = entry + list.size();
+    while (entry < end) {
+        auto next = static_cast<const char*>(memchr(entry, '\0', end - entry));
+        const int length = (next ? next : end) - entry;
+        if (visit(entry, length)) {
+            return true;
+        }
+        entry += length + 1;
+    }
+    return false;
+}
+
+// Processes connect from several Mir IPC threads at once, so each has its own buffer
+thread_local std::vector<char> readBuffer(4096);
+
+} // anonymous namespace
+
+ProcInfo::ProcInfo(const QByteArray &procPath)
+    : m_procPath(procPath)
+{
+}
+
+bool ProcInfo::readFile(pid_t pid, const char *name, QByteArray &contents) const
+{
+    char path[256];
+    if (snprintf(path, sizeof(path), "%s/%d/%s", m_procPath.constData(), pid, name) >= static_cast<int>(sizeof(path))) {
+        return false;
+    }
+
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    // Usually a single read, the buffer only grows for unusually long command lines or environments
+    std::vector<char> &buffer = readBuffer;
+    size_t size = 0;
+    for (;;) {
+        if (size == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        const ssize_t count = ::read(fd, buffer.data() + size, buffer.size() - size);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::close(fd);
+            return false;
+        }
+        if (count == 0) {
+            break;
+        }
+        size += count;
+    }
+    ::close(fd);
+
+    contents = QByteArray(buffer.data(), static_cast<int>(size));
+    return true;
+}
+
 std::unique_ptr<ProcInfo::CommandLine> ProcInfo::commandLine(pid_t pid)
 {
-    QFile cmdline(QStringLiteral("/proc/%1/cmdline").arg(pid));
-    if (!cmdline.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    std::unique_ptr<CommandLine> commandLine(new CommandLine);
+    if (!readFile(pid, "cmdline", commandLine->m_command)) {
         return nullptr;
     }
-
-    return std::unique_ptr<CommandLine>(new CommandLine{ cmdline.readLine().replace('\0', ' ') });
+    return commandLine;
 }
 
 QStringList ProcInfo::CommandLine::asStringList() const
 {
-    return QString(m_command.data()).split(' ');
+    QStringList arguments;
+    findEntry(m_command, [&arguments](const char *argument, int length) {
+        arguments << QString::fromUtf8(argument, length);
+        return false;
+    });
+    return arguments;
 }
 
 bool ProcInfo::CommandLine::startsWith(char const* prefix) const
@@ -50,44 +129,79 @@ bool ProcInfo::CommandLine::contains(char const* prefix) const
 
 QString ProcInfo::CommandLine::getParameter(const char* name) const
 {
-    QString pattern = QRegularExpression::escape(name) + "(\\S+)";
-    QRegularExpression regExp(pattern);
-    QRegularExpressionMatch regExpMatch = regExp.match(m_command);
-
-    if (!regExpMatch.hasMatch()) {
-        return QString();
-    }
-
-    return QString(regExpMatch.captured(1));
+    const int nameLength = strlen(name);
+    QString value;
+    findEntry(m_command, [&](const char *argument, int length) {
+        if (length > nameLength && memcmp(argument, name, nameLength) == 0) {
+            value = QString::fromUtf8(argument + nameLength, length - nameLength);
+            return true;
+        }
+        return false;
+    });
+    return value;
 }
 
 
 std::unique_ptr<ProcInfo::Environment> ProcInfo::environment(pid_t pid)
 {
-    QFile environment(QStringLiteral("/proc/%1/environ").arg(pid));
-    if (!environment.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    std::unique_ptr<Environment> environment(new Environment);
+    if (!readFile(pid, "environ", environment->m_environment)) {
         return nullptr;
     }
-
-    return std::unique_ptr<Environment>(new Environment{ environment.readLine().replace('\0', ' ') });
+    return environment;
 }
 
 bool ProcInfo::Environment::contains(char const* prefix) const
 {
-    return m_environment.contains(prefix);
+    const int nameLength = strlen(prefix);
+    return findEntry(m_environment, [&](const char *variable, int length) {
+        return length > nameLength && variable[nameLength] == '=' && memcmp(variable, prefix, nameLength) == 0;
+    });
 }
 
 QString ProcInfo::Environment::getParameter(const char* name) const
 {
-    QString pattern = QRegularExpression::escape(name) + "=(\\S+)";
-    QRegularExpression regExp(pattern);
-    QRegularExpressionMatch regExpMatch = regExp.match(m_environment);
+    const int nameLength = strlen(name);
+    QString value;
+    findEntry(m_environment, [&](const char *variable, int length) {
+        if (length > nameLength && variable[nameLength] == '=' && memcmp(variable, name, nameLength) == 0) {
+            if (length > nameLength + 1) {
+                value = QString::fromUtf8(variable + nameLength + 1, length - nameLength - 1);
+            }
+            return true;
+        }
+        return false;
+    });
+    return value;
+}
 
-    if (!regExpMatch.hasMatch()) {
-        return QString();
+qint64 ProcInfo::residentMemory(pid_t pid)
+{
+    // statm: size resident shared text lib data dt, in pages
+    QByteArray statm;
+    if (!readFile(pid, "statm", statm)) {
+        return -1;
+    }
+
+    const int separator = statm.indexOf(' ');
+    if (separator < 0) {
+        return -1;
+    }
+    const int end = statm.indexOf(' ', separator + 1);
+
+    bool ok;
+    const qint64 pages = statm.mid(separator + 1, end < 0 ? -1 : end - separator - 1).toLongLong(&ok);
+    if (!ok) {
+        return -1;
     }
 
-    return QString(regExpMatch.captured(1));
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+    return pages * pageSize;
+}
+
+quint64 ProcInfo::startTime(pid_t pid)
+{
+    return processStartTime(pid, QString::fromLocal8Bit(m_procPath));
 }
 
 } // namespace qtmir
@@ -31,28 +31,48 @@ class QString;
 namespace qtmir
 {
 
+/*
+  Reads the command line and environment of a process from /proc.
+
+  Both files are NUL separated lists, which are kept as-is so that arguments and variables can be
+  looked up exactly, even when they contain spaces or newlines.
+ */
 class ProcInfo
 {
 public:
+    explicit ProcInfo(const QByteArray &procPath = QByteArrayLiteral("/proc"));
+
     struct CommandLine {
-        QByteArray m_command;
+        QByteArray m_command; // NUL separated arguments
 
         bool startsWith(const char* prefix) const;
         bool contains(const char* prefix) const;
+        // The remainder of the first argument starting with name, null if there is none
         QString getParameter(const char* name) const;
         QStringList asStringList() const;
     };
 
     struct Environment {
-        QByteArray m_environment;
+        QByteArray m_environment; // NUL separated NAME=value entries
 
+        // Whether the variable with the given name is set
         bool contains(const char* prefix) const;
+        // The value of the variable with the given name, null if unset or empty
         QString getParameter(const char* name) const;
     };
 
     virtual std::unique_ptr<CommandLine> commandLine(pid_t pid);
     virtual std::unique_ptr<Environment> environment(pid_t pid);
+    // Resident set size in bytes, -1 if unknown
+    virtual qint64 residentMemory(pid_t pid);
+    // Clock ticks since boot at which the process started, 0 if unknown
+    virtual quint64 startTime(pid_t pid);
     virtual ~ProcInfo() = default;
+
+private:
+    bool readFile(pid_t pid, const char *name, QByteArray &contents) const;
+
+    const QByteArray m_procPath;
 };
 
 } // namespace qtmir
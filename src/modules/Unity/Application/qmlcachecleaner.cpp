@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qmlcachecleaner.h"
+
+// QPA mirserver
+#include "logging.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QDir>
+#include <QRunnable>
+#include <QStandardPaths>
+
+// std
+#include <functional>
+
+namespace qtmir
+{
+
+namespace {
+
+const QString trashPrefix = QStringLiteral(".trash-");
+
+class Task : public QRunnable
+{
+public:
+    explicit Task(const std::function<void()> &function) : m_function(function) {}
+    void run() override { m_function(); }
+
+private:
+    std::function<void()> m_function;
+};
+
+} // anonymous namespace
+
+QmlCacheCleaner::QmlCacheCleaner(const QString &path)
+    : m_cacheDir(path)
+{
+    // Deletions are done one at a time, there is no point in competing for the disk
+    m_worker.setMaxThreadCount(1);
+}
+
+QmlCacheCleaner::~QmlCacheCleaner()
+{
+    waitForDone();
+}
+
+QString QmlCacheCleaner::defaultCacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/QML/Apps");
+}
+
+QString QmlCacheCleaner::cacheDir() const
+{
+    return m_cacheDir.isEmpty() ? defaultCacheDir() : m_cacheDir;
+}
+
+void QmlCacheCleaner::wipe(const QString &appId)
+{
+    if (appId.isEmpty() || appId.contains(QLatin1Char('/')) || appId.startsWith(QLatin1Char('.'))) {
+        return;
+    }
+
+    const QString dir = cacheDir();
+
+    // Unversioned cache, the common case, is found without listing the cache directory
+    if (moveToTrash(dir, appId)) {
+        return;
+    }
+
+    // Caches of click packages are named after the versioned app id, which is unknown here. Listing the
+    // cache directory only reads one entry per application, so it is done right away as well.
+    const QStringList entries = QDir(dir).entryList(QStringList(appId + QStringLiteral("_*")),
+                                                    QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &entry : entries) {
+        moveToTrash(dir, entry);
+    }
+}
+
+void QmlCacheCleaner::removeLeftovers()
+{
+    const QString dir = cacheDir();
+    m_worker.start(new Task([this, dir]() {
+        const QStringList entries = QDir(dir).entryList(QStringList(trashPrefix + QLatin1Char('*')),
+                                                        QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+        for (const QString &entry : entries) {
+            removeTrash(dir, entry);
+        }
+    }));
+}
+
+void QmlCacheCleaner::waitForDone()
+{
+    m_worker.waitForDone();
+}
+
+bool QmlCacheCleaner::moveToTrash(const QString &cacheDir, const QString &entry)
+{
+    const QString trash = trashPrefix + QStringLiteral("%1-%2-%3")
+        .arg(entry)
+        .arg(QCoreApplication::applicationPid())
+        .arg(m_trashCount.fetchAndAddRelaxed(1));
+
+    // A rename within the same directory is atomic and takes the same time whatever the size of the cache
+    if (!QDir(cacheDir).rename(entry, trash)) {
+        return false;
+    }
+
+    qCDebug(QTMIR_APPLICATIONS) << "QmlCacheCleaner - wiping QML cache" << entry;
+    removeTrash(cacheDir, trash);
+    return true;
+}
+
+void QmlCacheCleaner::removeTrash(const QString &cacheDir, const QString &trash)
+{
+    m_worker.start(new Task([cacheDir, trash]() {
+        QDir dir(cacheDir + QLatin1Char('/') + trash);
+        if (!dir.removeRecursively()) {
+            qCWarning(QTMIR_APPLICATIONS) << "QmlCacheCleaner - failed to remove" << dir.absolutePath();
+        }
+    }));
+}
+
+} // namespace qtmir
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_QMLCACHECLEANER_H
+#define QTMIR_QMLCACHECLEANER_H
+
+#include <QAtomicInt>
+#include <QString>
+#include <QThreadPool>
+
+namespace qtmir
+{
+
+/*
+  Wipes the QML compilation cache of applications, kept in <cacheDir>/<appId>[_<version>]
+
+  The cache directory of an application is renamed out of the way right away, so that the application
+  can be restarted with a fresh cache immediately, and its contents are deleted in a background thread.
+  Only deletions are left to that thread, finding and renaming the cache is done by wipe() itself.
+
+  Without an explicit cache directory, defaultCacheDir() is resolved on every wipe.
+ */
+class QmlCacheCleaner
+{
+public:
+    explicit QmlCacheCleaner(const QString &path = QString());
+    ~QmlCacheCleaner(); // waits for pending deletions
+
+    void wipe(const QString &appId);
+
+    // Deletes in the background what a previous run did not get to delete before exiting
+    void removeLeftovers();
+
+    void waitForDone();
+
+    // $XDG_CACHE_HOME/QML/Apps
+    static QString defaultCacheDir();
+
+private:
+    QString cacheDir() const;
+    bool moveToTrash(const QString &cacheDir, const QString &entry);
+    void removeTrash(const QString &cacheDir, const QString &trash);
+
+    const QString m_cacheDir;
+    QAtomicInt m_trashCount;
+    QThreadPool m_worker;
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_QMLCACHECLEANER_H
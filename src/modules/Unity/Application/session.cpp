@@ -73,6 +73,7 @@ Session::Session(const std::shared_ptr<ms::Session>& session,
     , m_fullscreen(false)
     , m_state(State::Starting)
     , m_live(true)
+    , m_timeSource(new RealTimeSource)
     , m_promptSessionManager(promptSessionManager)
 {
     DEBUG_MSG << "()";
@@ -106,15 +107,53 @@ void Session::doSuspend()
 {
     Q_ASSERT(m_state == Session::Suspending);
 
-    if (m_surfaceList.count() == 0) {
-        DEBUG_MSG << " no surface to call stopFrameDropper() on!";
-    } else {
-        for (int i = 0; i < m_surfaceList.count(); ++i) {
-            auto surface = static_cast<MirSurfaceInterface*>(m_surfaceList.get(i));
-            surface->stopFrameDropper();
+    // The whole tree suspended by suspend() gets suspended at once. Children that are not
+    // Sessions were told to suspend on their own and complete their suspension themselves.
+    QVector<SessionInterface*> otherSessions;
+    const QVector<Session*> tree = sessionTree([](Session *session) { return session->m_state == Suspending; },
+                                               otherSessions);
+
+    for (Session *session : tree) {
+        if (session->m_surfaceList.count() == 0) {
+            DEBUG_MSG << " no surface to call stopFrameDropper() on!";
+        } else {
+            for (int i = 0; i < session->m_surfaceList.count(); ++i) {
+                auto surface = static_cast<MirSurfaceInterface*>(session->m_surfaceList.get(i));
+                surface->stopFrameDropper();
+            }
         }
+
+        session->m_lifecycleLatency.suspended(session->m_timeSource->msecsSinceReference());
+    }
+    DEBUG_MSG << " latencies (ms): " << m_lifecycleLatency.toVariantMap();
+
+    setStates(tree, Suspended);
+}
+
+QVector<Session*> Session::sessionTree(const std::function<bool(Session*)> &included,
+                                       QVector<SessionInterface*> &otherSessions)
+{
+    // Breadth first, so parents always come before their children
+    QVector<Session*> tree{this};
+    for (int i = 0; i < tree.count(); ++i) {
+        tree[i]->foreachChildSession([&](SessionInterface *child) {
+            Session *session = qobject_cast<Session*>(child);
+            if (!session) {
+                otherSessions.append(child);
+            } else if (included(session)) {
+                tree.append(session);
+            }
+        });
+    }
+    return tree;
+}
+
+void Session::setStates(const QVector<Session*> &tree, State state)
+{
+    // Children first, a session being in a state implies its children are in it too
+    for (int i = tree.count() - 1; i >= 0; --i) {
+        tree[i]->setState(state);
     }
-    setState(Suspended);
 }
 
 QString Session::name() const
@@ -157,6 +196,9 @@ void Session::setState(State state)
 
     if (m_state == Suspending) {
         m_suspendTimer->stop();
+        if (state != Suspended) {
+            m_lifecycleLatency.suspendCancelled();
+        }
     }
 
     m_state = state;
@@ -164,10 +206,7 @@ void Session::setState(State state)
     switch (m_state) {
         case Starting:
         case Running:
-            break;
-        case Suspending:
-            m_suspendTimer->start();
-            break;
+        case Suspending: // suspend() starts the suspend timer of the topmost session only
         case Suspended:
         case Stopped:
             break;
@@ -234,6 +273,11 @@ void Session::prependSurface(MirSurfaceInterface *newSurface)
             this->removeSurface(newSurface);
         });
     connect(newSurface, &MirSurfaceInterface::focusRequested, this, &SessionInterface::focusRequested);
+    connect(newSurface, &MirSurfaceInterface::framesPosted, this, [this]() {
+        if (m_lifecycleLatency.waitingForFrame()) {
+            m_lifecycleLatency.framePosted(m_timeSource->msecsSinceReference());
+        }
+    });
     connect(newSurface, &MirSurfaceInterface::focusedChanged, this, [&](bool /*value*/) {
         // TODO: May want to optimize that in the future.
         Q_EMIT focusedChanged(focused());
@@ -297,20 +341,36 @@ void Session::setFullscreen(bool fullscreen)
 void Session::suspend()
 {
     DEBUG_MSG << " state=" << sessionStateToString(m_state);
-    if (m_state == Running) {
-        miral::apply_lifecycle_state_to(session(), mir_lifecycle_state_will_suspend);
-        m_suspendTimer->start();
+    if (m_state != Running) {
+        return;
+    }
 
-        foreachPromptSession([this](const qtmir::PromptSession &promptSession) {
-            m_promptSessionManager->suspendPromptSession(promptSession);
-        });
+    // The whole tree of running sessions is told to suspend in one go, and gets suspended
+    // together once the slowest of them has been given enough time to get ready.
+    QVector<SessionInterface*> otherSessions;
+    const QVector<Session*> tree = sessionTree([](Session *session) { return session->m_state == Running; },
+                                               otherSessions);
+
+    int suspendTimeout = 0;
+    for (Session *session : tree) {
+        session->m_lifecycleLatency.suspendRequested(session->m_timeSource->msecsSinceReference());
+        suspendTimeout = qMax(suspendTimeout, session->m_lifecycleLatency.suspendTimeout());
+        miral::apply_lifecycle_state_to(session->session(), mir_lifecycle_state_will_suspend);
+    }
+    m_suspendTimer->setInterval(suspendTimeout);
+    m_suspendTimer->start();
 
-        foreachChildSession([](SessionInterface* session) {
-            session->suspend();
+    for (Session *session : tree) {
+        session->foreachPromptSession([session](const qtmir::PromptSession &promptSession) {
+            session->m_promptSessionManager->suspendPromptSession(promptSession);
         });
+    }
 
-        setState(Suspending);
+    for (SessionInterface *session : otherSessions) {
+        session->suspend();
     }
+
+    setStates(tree, Suspending);
 }
 
 void Session::resume()
@@ -324,24 +384,35 @@ void Session::resume()
 
 void Session::doResume()
 {
-    if (m_state == Suspended) {
-        for (int i = 0; i < m_surfaceList.count(); ++i) {
-            auto surface = static_cast<MirSurfaceInterface*>(m_surfaceList.get(i));
-            surface->startFrameDropper();
+    QVector<SessionInterface*> otherSessions;
+    const QVector<Session*> tree = sessionTree(
+        [](Session *session) { return session->m_state == Suspending || session->m_state == Suspended; },
+        otherSessions);
+
+    for (Session *session : tree) {
+        session->m_lifecycleLatency.resumeRequested(session->m_timeSource->msecsSinceReference());
+
+        if (session->m_state == Suspended) {
+            for (int i = 0; i < session->m_surfaceList.count(); ++i) {
+                auto surface = static_cast<MirSurfaceInterface*>(session->m_surfaceList.get(i));
+                surface->startFrameDropper();
+            }
         }
-    }
 
-    miral::apply_lifecycle_state_to(session(), mir_lifecycle_state_resumed);
+        miral::apply_lifecycle_state_to(session->session(), mir_lifecycle_state_resumed);
+    }
 
-    foreachPromptSession([this](const qtmir::PromptSession &promptSession) {
-        m_promptSessionManager->resumePromptSession(promptSession);
-    });
+    for (Session *session : tree) {
+        session->foreachPromptSession([session](const qtmir::PromptSession &promptSession) {
+            session->m_promptSessionManager->resumePromptSession(promptSession);
+        });
+    }
 
-    foreachChildSession([](SessionInterface* session) {
+    for (SessionInterface *session : otherSessions) {
         session->resume();
-    });
+    }
 
-    setState(Running);
+    setStates(tree, Running);
 }
 
 void Session::close()
@@ -449,6 +520,12 @@ void Session::removeChildSession(SessionInterface* session)
         m_children->remove(session);
         m_promptSurfaceList.removeSurfaceList(session->surfaceList());
         m_promptSurfaceList.removeSurfaceList(session->promptSurfaceList());
+
+        // It was waiting for our suspend timer, now it has to finish suspending on its own
+        Session *child = qobject_cast<Session*>(session);
+        if (child && child->m_state == Suspending && !child->m_suspendTimer->isRunning()) {
+            child->m_suspendTimer->start();
+        }
     }
 
     deleteIfZombieAndEmpty();
@@ -569,7 +646,7 @@ void Session::setSuspendTimer(AbstractTimer *timer)
     }
 
     m_suspendTimer = timer;
-    m_suspendTimer->setInterval(1500);
+    m_suspendTimer->setInterval(m_lifecycleLatency.suspendTimeout());
     m_suspendTimer->setSingleShot(true);
     connect(m_suspendTimer, &AbstractTimer::timeout, this, &Session::doSuspend);
 
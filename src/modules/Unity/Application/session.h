@@ -18,13 +18,16 @@
 #define SESSION_H
 
 // std
+#include <functional>
 #include <memory>
 
 // local
 #include "session_interface.h"
+#include "lifecyclelatency.h"
 #include "mirsurfacelistmodel.h"
 #include "promptsessionmanager.h"
 #include "timer.h"
+#include "timesource.h"
 
 // Qt
 #include <QObject>
@@ -87,9 +90,12 @@ public:
     void appendPromptSession(const PromptSession& session) override;
     void removePromptSession(const PromptSession& session) override;
 
+    const LifecycleLatency &lifecycleLatency() const { return m_lifecycleLatency; }
+
     // useful for tests
     void setSuspendTimer(AbstractTimer *timer);
     AbstractTimer *suspendTimer() const { return m_suspendTimer; }
+    void setTimeSource(const SharedTimeSource &timeSource) { m_timeSource = timeSource; }
 
 public Q_SLOTS:
     // it's public to ease testing
@@ -106,6 +112,12 @@ protected:
 
     void stopPromptSessions();
 
+    // This session and all its descendants that are Sessions for which included() is true,
+    // only looking into the children of the included ones. Other children are put in otherSessions.
+    QVector<Session*> sessionTree(const std::function<bool(Session*)> &included,
+                                  QVector<SessionInterface*> &otherSessions);
+    static void setStates(const QVector<Session*> &tree, State state);
+
     void prependSurface(MirSurfaceInterface* surface);
 
     std::shared_ptr<mir::scene::Session> m_session;
@@ -118,6 +130,8 @@ protected:
     State m_state;
     bool m_live;
     AbstractTimer* m_suspendTimer{nullptr};
+    SharedTimeSource m_timeSource;
+    LifecycleLatency m_lifecycleLatency;
     QVector<PromptSession> m_promptSessions;
     std::shared_ptr<PromptSessionManager> const m_promptSessionManager;
     QList<MirSurfaceInterface*> m_closingSurfaces;
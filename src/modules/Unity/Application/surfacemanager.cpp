@@ -71,28 +71,23 @@ void SurfaceManager::connectToWindowModelNotifier(WindowModelNotifier *notifier)
     connect(notifier, &WindowModelNotifier::windowAdded,          this, &SurfaceManager::onWindowAdded,           Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowRemoved,        this, &SurfaceManager::onWindowRemoved,         Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowReady,          this, &SurfaceManager::onWindowReady,           Qt::QueuedConnection);
-    connect(notifier, &WindowModelNotifier::windowMoved,          this, &SurfaceManager::onWindowMoved,           Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowStateChanged,   this, &SurfaceManager::onWindowStateChanged,    Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowFocusChanged,   this, &SurfaceManager::onWindowFocusChanged,    Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowsRaised,        this, &SurfaceManager::onWindowsRaised,         Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowRequestedRaise, this, &SurfaceManager::onWindowsRequestedRaise, Qt::QueuedConnection);
+    connect(notifier, &WindowModelNotifier::windowsChanged,       this, &SurfaceManager::onWindowsChanged,        Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::modificationsStarted, this, &SurfaceManager::modificationsStarted,    Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::modificationsEnded,   this, &SurfaceManager::modificationsEnded,      Qt::QueuedConnection);
 }
 
 void SurfaceManager::rememberMirSurface(MirSurface *surface)
 {
-    m_allSurfaces.append(surface);
+    m_allSurfaces[surface->window()] = surface;
 }
 
 void SurfaceManager::forgetMirSurface(const miral::Window &window)
 {
-    for (int i = 0; i < m_allSurfaces.count(); ++i) {
-        if (m_allSurfaces[i]->window() == window) {
-            m_allSurfaces.removeAt(i);
-            return;
-        }
-    }
+    m_allSurfaces.erase(window);
 }
 
 void SurfaceManager::onWindowAdded(const NewWindow &window)
@@ -153,12 +148,8 @@ MirSurface *SurfaceManager::find(const miral::WindowInfo &needle) const
 
 MirSurface *SurfaceManager::find(const miral::Window &window) const
 {
-    Q_FOREACH(const auto surface, m_allSurfaces) {
-        if (surface->window() == window) {
-            return surface;
-        }
-    }
-    return nullptr;
+    auto it = m_allSurfaces.find(window);
+    return it != m_allSurfaces.end() ? it->second : nullptr;
 }
 
 void SurfaceManager::onWindowReady(const miral::WindowInfo &windowInfo)
@@ -169,13 +160,6 @@ void SurfaceManager::onWindowReady(const miral::WindowInfo &windowInfo)
     }
 }
 
-void SurfaceManager::onWindowMoved(const miral::WindowInfo &windowInfo, const QPoint topLeft)
-{
-    if (auto mirSurface = find(windowInfo)) {
-        mirSurface->setPosition(topLeft);
-    }
-}
-
 void SurfaceManager::onWindowFocusChanged(const miral::WindowInfo &windowInfo, bool focused)
 {
     if (auto mirSurface = find(windowInfo)) {
@@ -217,6 +201,15 @@ void SurfaceManager::onWindowsRequestedRaise(const miral::WindowInfo &windowInfo
     }
 }
 
+void SurfaceManager::onWindowsChanged(const WindowModelChanges &changes)
+{
+    DEBUG_MSG << "() moved = " << changes.moved.size() << ", stateChanged = " << changes.stateChanged.size()
+              << ", focusChanged = " << changes.focusChanged.size() << ", raised = " << changes.raised.size();
+
+    changes.apply([this](const miral::Window &window) { return find(window); },
+                  [this](const std::vector<miral::Window> &windows) { onWindowsRaised(windows); });
+}
+
 void SurfaceManager::raise(unityapi::MirSurfaceInterface *surface)
 {
     DEBUG_MSG << "(" << surface << ")";
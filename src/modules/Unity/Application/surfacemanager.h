@@ -26,6 +26,8 @@
 #include <QVector>
 #include <QLoggingCategory>
 
+#include <map>
+
 Q_DECLARE_LOGGING_CATEGORY(QTMIR_SURFACEMANAGER)
 
 namespace qtmir {
@@ -55,11 +57,11 @@ private Q_SLOTS:
     void onWindowAdded(const qtmir::NewWindow &windowInfo);
     void onWindowRemoved(const miral::WindowInfo &windowInfo);
     void onWindowReady(const miral::WindowInfo &windowInfo);
-    void onWindowMoved(const miral::WindowInfo &windowInfo, const QPoint topLeft);
     void onWindowStateChanged(const miral::WindowInfo &windowInfo, Mir::State state);
     void onWindowFocusChanged(const miral::WindowInfo &windowInfo, bool focused);
     void onWindowsRaised(const std::vector<miral::Window> &windows);
     void onWindowsRequestedRaise(const miral::WindowInfo &windowInfo);
+    void onWindowsChanged(const qtmir::WindowModelChanges &changes);
 
 private:
     void connectToWindowModelNotifier(WindowModelNotifier *notifier);
@@ -67,7 +69,7 @@ private:
     void forgetMirSurface(const miral::Window &window);
     MirSurface* find(const miral::Window &needle) const;
 
-    QVector<MirSurface*> m_allSurfaces;
+    std::map<miral::Window, MirSurface*> m_allSurfaces;
 
     WindowControllerInterface *m_windowController;
     SessionMapInterface *m_sessionMap;
@@ -68,12 +68,13 @@ void TaskController::onSessionStarting(const miral::ApplicationInfo &appInfo)
 
     const auto &session = appInfo.application();
     Session* qmlSession = new Session(session, m_promptSessionManager);
+    const mir::scene::Session *mirSession = session.get();
     m_sessionList.prepend(qmlSession);
+    m_sessionsByMirSession.insert(mirSession, qmlSession);
 
     // need to remove if we've destroyed outside
-    connect(qmlSession, &Session::destroyed, this, [&](QObject *item) {
-        auto sessionToRemove = static_cast<Session*>(item);
-        m_sessionList.removeAll(sessionToRemove);
+    connect(qmlSession, &Session::destroyed, this, [this, mirSession](QObject *item) {
+        removeSession(static_cast<Session*>(item), mirSession);
     });
 
     Q_EMIT sessionStarting(qmlSession);
@@ -83,10 +84,11 @@ void TaskController::onSessionStopping(const miral::ApplicationInfo &appInfo)
 {
     DEBUG_MSG << " - sessionName=" << appInfo.name().c_str();
 
-    SessionInterface* qmlSession = findSession(appInfo.application().get());
+    const auto &session = appInfo.application();
+    SessionInterface* qmlSession = findSession(session.get());
     if (!qmlSession) return;
 
-    m_sessionList.removeAll(qmlSession);
+    removeSession(qmlSession, session.get());
 
     qmlSession->setLive(false);
 }
@@ -152,11 +154,13 @@ SessionInterface *TaskController::findSession(const mir::scene::Session* session
 {
     if (!session) return nullptr;
 
-    for (SessionInterface* child : m_sessionList) {
-        if (child->session().get() == session)
-            return child;
-    }
-    return nullptr;
+    return m_sessionsByMirSession.value(session, nullptr);
+}
+
+void TaskController::removeSession(SessionInterface *qmlSession, const mir::scene::Session *session)
+{
+    m_sessionList.removeAll(qmlSession);
+    m_sessionsByMirSession.remove(session, qmlSession);
 }
 
 void TaskController::connectToAppNotifier(AppNotifier *appNotifier)
@@ -18,6 +18,7 @@
 #ifndef QTMIR_TASK_CONTROLLER_H
 #define QTMIR_TASK_CONTROLLER_H
 
+#include <QHash>
 #include <QObject>
 #include <QSharedPointer>
 #include <QString>
@@ -111,11 +112,13 @@ protected:
 private:
     void connectToAppNotifier(AppNotifier *);
     void connectToPromptSessionListener(PromptSessionListener *);
+    void removeSession(SessionInterface *qmlSession, const mir::scene::Session *session);
 
     std::shared_ptr<PromptSessionManager> m_promptSessionManager;
 
     QHash<const mir::scene::PromptSession *, SessionInterface *> m_mirPromptToSessionHash;
     QList<SessionInterface*> m_sessionList;
+    QMultiHash<const mir::scene::Session *, SessionInterface *> m_sessionsByMirSession;
 };
 
 } // namespace qtmir
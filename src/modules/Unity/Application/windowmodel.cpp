@@ -24,6 +24,10 @@
 // Qt
 #include <QGuiApplication>
 #include <QDebug>
+#include <QSet>
+
+// std
+#include <algorithm>
 
 using namespace qtmir;
 
@@ -53,10 +57,10 @@ void WindowModel::connectToWindowModelNotifier(WindowModelNotifier *notifier)
     connect(notifier, &WindowModelNotifier::windowAdded,        this, &WindowModel::onWindowAdded,        Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowRemoved,      this, &WindowModel::onWindowRemoved,      Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowReady,        this, &WindowModel::onWindowReady,        Qt::QueuedConnection);
-    connect(notifier, &WindowModelNotifier::windowMoved,        this, &WindowModel::onWindowMoved,        Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowStateChanged, this, &WindowModel::onWindowStateChanged, Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowFocusChanged, this, &WindowModel::onWindowFocusChanged, Qt::QueuedConnection);
     connect(notifier, &WindowModelNotifier::windowsRaised,      this, &WindowModel::onWindowsRaised,      Qt::QueuedConnection);
+    connect(notifier, &WindowModelNotifier::windowsChanged,     this, &WindowModel::onWindowsChanged,     Qt::QueuedConnection);
 }
 
 QHash<int, QByteArray> WindowModel::roleNames() const
@@ -76,6 +80,7 @@ void WindowModel::onWindowAdded(const NewWindow &window)
     const int index = m_windowModel.count();
     beginInsertRows(QModelIndex(), index, index);
     m_windowModel.append(new MirSurface(window, m_windowController));
+    m_rowsByWindow[window.windowInfo.window()] = index;
     endInsertRows();
     Q_EMIT countChanged();
 }
@@ -91,6 +96,8 @@ void WindowModel::onWindowRemoved(const miral::WindowInfo &windowInfo)
 
     beginRemoveRows(QModelIndex(), index, index);
     m_windowModel.takeAt(index);
+    m_rowsByWindow.erase(windowInfo.window());
+    updateRows(index, m_windowModel.count() - 1);
     endRemoveRows();
     Q_EMIT countChanged();
 }
@@ -102,13 +109,6 @@ void WindowModel::onWindowReady(const miral::WindowInfo &windowInfo)
     }
 }
 
-void WindowModel::onWindowMoved(const miral::WindowInfo &windowInfo, const QPoint topLeft)
-{
-    if (auto mirSurface = find(windowInfo)) {
-        mirSurface->setPosition(topLeft);
-    }
-}
-
 void WindowModel::onWindowFocusChanged(const miral::WindowInfo &windowInfo, bool focused)
 {
     if (auto mirSurface = find(windowInfo)) {
@@ -123,6 +123,12 @@ void WindowModel::onWindowStateChanged(const miral::WindowInfo &windowInfo, Mir:
     }
 }
 
+void WindowModel::onWindowsChanged(const WindowModelChanges &changes)
+{
+    changes.apply([this](const miral::Window &window) { return find(window); },
+                  [this](const std::vector<miral::Window> &windows) { onWindowsRaised(windows); });
+}
+
 void WindowModel::addInputMethodWindow(const NewWindow &windowInfo)
 {
     if (m_inputMethodSurface) {
@@ -144,53 +150,71 @@ void WindowModel::removeInputMethodWindow()
 
 void WindowModel::onWindowsRaised(const std::vector<miral::Window> &windows)
 {
-    // Reminder: last item in the "windows" list should end up at the top of the model
+    // Reminder: last item in the "windows" list should end up at the top of the model, the windows
+    // not in the list keep their relative order below the raised ones.
     const int modelCount = m_windowModel.count();
-    const int raiseCount = windows.size();
-
-    // Assumption: no NO-OPs are in this list - Qt will crash on endMoveRows() if you try NO-OPs!!!
-    // A NO-OP is if
-    //    1. "indices" is an empty list
-    //    2. "indices" of the form (..., modelCount - 2, modelCount - 1) which results in an unchanged list
-
-    // Precompute the list of indices of Windows/Surfaces to raise, including the offsets due to
-    // indices which have already been moved.
-    QVector<QPair<int /*from*/, int /*to*/>> moveList;
-
-    for (int i=raiseCount-1; i>=0; i--) {
-        int from = findIndexOf(windows[i]);
-        const int to = modelCount - raiseCount + i;
-
-        int moveCount = 0;
-        // how many list items under "index" have been moved so far, correct "from" to suit
-        for (int j=raiseCount-1; j>i; j--) {
-            if (findIndexOf(windows[j]) < from) {
-                moveCount++;
-            }
+
+    // Group the raised windows in runs which are already contiguous and in order in the model,
+    // each run is then restacked with a single row move.
+    struct Run { int first; int count; };
+    QVector<Run> runs;
+    QSet<int> raisedRows;
+    for (const auto &window : windows) {
+        const int row = findIndexOf(window);
+        if (row < 0 || raisedRows.contains(row)) {
+            continue; // not in this model (e.g. input method) or listed twice
         }
-        from -= moveCount;
+        raisedRows.insert(row);
 
-        if (from == to) {
-            // is NO-OP, would result in moving element to itself
+        if (!runs.isEmpty() && runs.last().first + runs.last().count == row) {
+            runs.last().count++;
         } else {
-            moveList.prepend({from, to});
+            runs.append({row, 1});
         }
     }
+    if (runs.isEmpty()) {
+        return;
+    }
+
+    // Raised windows already at the top, in order, stay where they are
+    int stableTop = modelCount;
+    if (runs.last().first + runs.last().count == modelCount) {
+        stableTop = runs.takeLast().first;
+    }
+
+    // Each run is moved right below the stable top, above the runs moved before it. By the time a run
+    // is moved, every earlier run which was below it has left, so it has shifted down by their sizes.
+    // A Fenwick tree over the ranks of the runs' rows sums those sizes in O(log k).
+    QVector<int> sortedFirsts;
+    sortedFirsts.reserve(runs.count());
+    for (const auto &run : runs) {
+        sortedFirsts.append(run.first);
+    }
+    std::sort(sortedFirsts.begin(), sortedFirsts.end());
+    QVector<int> movedBelow(runs.count() + 1, 0);
 
-    // Perform the moving, trusting the moveList is correct for each iteration.
     QModelIndex parent;
-    for (int i=moveList.count()-1; i>=0; i--) {
-        const int from = moveList[i].first;
-        const int to = moveList[i].second;
-
-        beginMoveRows(parent, from, from, parent, to+1);
-#if QT_VERSION < QT_VERSION_CHECK(5, 6, 0)
-        const auto &window = m_windowModel.takeAt(from);
-        m_windowModel.insert(to, window);
-#else
-        m_windowModel.move(from, to);
-#endif
+    for (const auto &run : runs) {
+        const int rank = std::lower_bound(sortedFirsts.begin(), sortedFirsts.end(), run.first) - sortedFirsts.begin();
+
+        int shift = 0;
+        for (int i = rank; i > 0; i -= i & -i) {
+            shift += movedBelow[i];
+        }
+        for (int i = rank + 1; i <= runs.count(); i += i & -i) {
+            movedBelow[i] += run.count;
+        }
 
+        const int from = run.first - shift;
+        const int last = from + run.count - 1;
+        const int to = stableTop - 1; // row of the last window of the run once moved
+        if (last == to) {
+            continue; // already in place, Qt does not accept moving rows onto themselves
+        }
+
+        beginMoveRows(parent, from, last, parent, to + 1);
+        std::rotate(m_windowModel.begin() + from, m_windowModel.begin() + last + 1, m_windowModel.begin() + to + 1);
+        updateRows(from, to);
         endMoveRows();
     }
 }
@@ -215,21 +239,25 @@ QVariant WindowModel::data(const QModelIndex &index, int role) const
 
 MirSurface *WindowModel::find(const miral::WindowInfo &needle) const
 {
-    auto window = needle.window();
-    Q_FOREACH(const auto mirSurface, m_windowModel) {
-        if (mirSurface->window() == window) {
-            return mirSurface;
-        }
-    }
-    return nullptr;
+    return find(needle.window());
+}
+
+MirSurface *WindowModel::find(const miral::Window &needle) const
+{
+    const int index = findIndexOf(needle);
+    return index >= 0 ? m_windowModel[index] : nullptr;
 }
 
 int WindowModel::findIndexOf(const miral::Window &needle) const
 {
-    for (int i=0; i<m_windowModel.count(); i++) {
-        if (m_windowModel[i]->window() == needle) {
-            return i;
-        }
+    auto it = m_rowsByWindow.find(needle);
+    return it != m_rowsByWindow.end() ? it->second : -1;
+}
+
+// Rows first to last (inclusive) were shifted in m_windowModel, record where their windows are now
+void WindowModel::updateRows(int first, int last)
+{
+    for (int i = first; i <= last; i++) {
+        m_rowsByWindow[m_windowModel[i]->window()] = i;
     }
-    return -1;
 }
@@ -22,6 +22,8 @@
 #include "mirsurface.h"
 #include "windowmodelnotifier.h"
 
+#include <map>
+
 namespace qtmir {
 
 class WindowControllerInterface;
@@ -61,10 +63,10 @@ private Q_SLOTS:
     void onWindowAdded(const qtmir::NewWindow &windowInfo);
     void onWindowRemoved(const miral::WindowInfo &windowInfo);
     void onWindowReady(const miral::WindowInfo &windowInfo);
-    void onWindowMoved(const miral::WindowInfo &windowInfo, const QPoint topLeft);
     void onWindowStateChanged(const miral::WindowInfo &windowInfo, Mir::State state);
     void onWindowFocusChanged(const miral::WindowInfo &windowInfo, bool focused);
     void onWindowsRaised(const std::vector<miral::Window> &windows);
+    void onWindowsChanged(const qtmir::WindowModelChanges &changes);
 
 private:
     void connectToWindowModelNotifier(WindowModelNotifier *notifier);
@@ -72,9 +74,12 @@ private:
     void addInputMethodWindow(const NewWindow &windowInfo);
     void removeInputMethodWindow();
     MirSurface* find(const miral::WindowInfo &needle) const;
+    MirSurface* find(const miral::Window &needle) const;
     int findIndexOf(const miral::Window &needle) const;
+    void updateRows(int first, int last);
 
     QVector<MirSurface*> m_windowModel;
+    std::map<miral::Window, int> m_rowsByWindow; // row of each window in m_windowModel
     WindowControllerInterface *m_windowController;
     MirSurface* m_inputMethodSurface{nullptr};
 };
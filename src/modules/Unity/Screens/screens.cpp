@@ -18,15 +18,28 @@
 
 // mirserver
 #include "screen.h"
+#include "screenscontroller.h"
 
 // Qt
 #include <QGuiApplication>
 #include <QScreen>
+#include <qpa/qplatformnativeinterface.h>
 
 Q_DECLARE_METATYPE(QScreen*)
 
 namespace qtmir {
 
+namespace {
+ScreensController *screensController()
+{
+    auto nativeInterface = qGuiApp ? qGuiApp->platformNativeInterface() : nullptr;
+    if (!nativeInterface) {
+        return nullptr;
+    }
+    return static_cast<ScreensController*>(nativeInterface->nativeResourceForIntegration("ScreensController"));
+}
+} // namespace
+
 Screens::Screens(QObject *parent) :
     QAbstractListModel(parent)
 {
@@ -98,6 +111,60 @@ int Screens::count() const
     return m_screenList.size();
 }
 
+QVariantList Screens::frameTimings(int index, int maxCount) const
+{
+    QVariantList result;
+    if (index < 0 || index >= m_screenList.size()) {
+        return result;
+    }
+
+    auto screen = static_cast<Screen*>(m_screenList.at(index)->handle());
+    if (!screen) {
+        return result;
+    }
+
+    auto toMsecs = [](int64_t nsecs) { return nsecs / 1e6; };
+
+    const auto timings = screen->frameTimings(maxCount);
+    result.reserve(timings.count());
+    for (const auto &timing : timings) {
+        QVariantMap entry;
+        entry[QStringLiteral("frameNumber")] = static_cast<qulonglong>(timing.frameNumber);
+        entry[QStringLiteral("makeCurrent")] = toMsecs(timing.makeCurrent);
+        entry[QStringLiteral("render")] = toMsecs(timing.render);
+        entry[QStringLiteral("swap")] = toMsecs(timing.swap);
+        entry[QStringLiteral("post")] = toMsecs(timing.post);
+        entry[QStringLiteral("missedVBlanks")] = timing.missedVBlanks;
+        result.append(entry);
+    }
+    return result;
+}
+
+void Screens::beginConfiguration()
+{
+    auto controller = screensController();
+    if (controller) {
+        controller->beginConfiguration();
+    }
+}
+
+bool Screens::commitConfiguration()
+{
+    auto controller = screensController();
+    if (!controller) {
+        return false;
+    }
+    return controller->commitConfiguration();
+}
+
+void Screens::abortConfiguration()
+{
+    auto controller = screensController();
+    if (controller) {
+        controller->abortConfiguration();
+    }
+}
+
 void Screens::onScreenAdded(QScreen *screen)
 {
     if (m_screenList.contains(screen))
@@ -51,6 +51,17 @@ public:
 
     int count() const;
 
+    // Most recent frame timings of the screen at the given row, oldest first. Each entry is a map with
+    // the "frameNumber", "makeCurrent", "render", "swap", "post" (all in milliseconds) and "missedVBlanks" keys
+    Q_INVOKABLE QVariantList frameTimings(int index, int maxCount = 60) const;
+
+    // Screen configuration changes made between these calls (e.g. through ScreenWindow.setScaleAndFormFactor)
+    // are applied together, stopping and restarting the compositor only once. abortConfiguration drops
+    // them all, call it when bailing out before the commit.
+    Q_INVOKABLE void beginConfiguration();
+    Q_INVOKABLE bool commitConfiguration();
+    Q_INVOKABLE void abortConfiguration();
+
 Q_SIGNALS:
     void countChanged();
     void screenAdded(QScreen *screen);
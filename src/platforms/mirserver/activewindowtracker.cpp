@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "activewindowtracker.h"
+
+#include <QMutexLocker>
+
+namespace qtmir {
+
+void ActiveWindowTracker::focusGained(const miral::Window &window)
+{
+    QMutexLocker lock(&m_mutex);
+    m_activeWindow = window;
+}
+
+void ActiveWindowTracker::focusLost(const miral::Window &window)
+{
+    QMutexLocker lock(&m_mutex);
+    if (m_activeWindow == window) {
+        m_activeWindow = miral::Window();
+    }
+}
+
+bool ActiveWindowTracker::isActive(const miral::Window &window) const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_activeWindow == window;
+}
+
+void ActiveWindowTracker::ensureActive(const miral::Window &window, const std::function<void()> &activate)
+{
+    if (isActive(window)) {
+        ++m_activationsSkipped;
+        return;
+    }
+
+    // The focus may have changed meanwhile, activate has to check again under the window manager lock
+    ++m_activationsAttempted;
+    activate();
+}
+
+} // namespace qtmir
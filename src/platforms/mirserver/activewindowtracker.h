@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_ACTIVEWINDOWTRACKER_H
+#define QTMIR_ACTIVEWINDOWTRACKER_H
+
+#include <QMutex>
+
+#include <miral/window.h>
+
+#include <atomic>
+#include <functional>
+
+namespace qtmir {
+
+/*
+  Keeps track of the window Mir last gave focus to, so that delivering input to the active window, by far the
+  most common case, does not need to take the window manager lock just to find out nothing has to be done.
+
+  Updated from the advise_focus_* notifications (window manager lock held), read from the Qt GUI thread.
+ */
+class ActiveWindowTracker
+{
+public:
+    void focusGained(const miral::Window &window);
+    void focusLost(const miral::Window &window);
+
+    bool isActive(const miral::Window &window) const;
+
+    // Calls activate, which is expected to take the window manager lock, unless window is active already
+    void ensureActive(const miral::Window &window, const std::function<void()> &activate);
+
+    quint64 activationsSkipped() const { return m_activationsSkipped; }
+    quint64 activationsAttempted() const { return m_activationsAttempted; }
+
+private:
+    mutable QMutex m_mutex; // never held for more than a comparison, unlike the window manager lock
+    miral::Window m_activeWindow;
+
+    std::atomic<quint64> m_activationsSkipped{0};
+    std::atomic<quint64> m_activationsAttempted{0};
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_ACTIVEWINDOWTRACKER_H
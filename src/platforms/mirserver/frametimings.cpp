@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frametimings.h"
+
+namespace qtmir {
+
+void FrameTimingRing::push(const FrameTiming &timing)
+{
+    const uint64_t index = m_written.load(std::memory_order_relaxed);
+    Slot &slot = m_slots[index % Capacity];
+
+    // odd sequence means "being written"
+    const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.frameNumber.store(index, std::memory_order_relaxed);
+    slot.makeCurrent.store(timing.makeCurrent, std::memory_order_relaxed);
+    slot.render.store(timing.render, std::memory_order_relaxed);
+    slot.swap.store(timing.swap, std::memory_order_relaxed);
+    slot.post.store(timing.post, std::memory_order_relaxed);
+    slot.missedVBlanks.store(timing.missedVBlanks, std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    m_written.store(index + 1, std::memory_order_release);
+}
+
+QVector<FrameTiming> FrameTimingRing::snapshot(int maxCount) const
+{
+    QVector<FrameTiming> result;
+
+    const uint64_t written = m_written.load(std::memory_order_acquire);
+    const uint64_t available = qMin<uint64_t>(written, qBound(0, maxCount, static_cast<int>(Capacity)));
+    result.reserve(static_cast<int>(available));
+
+    for (uint64_t index = written - available; index < written; ++index) {
+        const Slot &slot = m_slots[index % Capacity];
+
+        const uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+
+        FrameTiming timing;
+        timing.frameNumber = slot.frameNumber.load(std::memory_order_relaxed);
+        timing.makeCurrent = slot.makeCurrent.load(std::memory_order_relaxed);
+        timing.render = slot.render.load(std::memory_order_relaxed);
+        timing.swap = slot.swap.load(std::memory_order_relaxed);
+        timing.post = slot.post.load(std::memory_order_relaxed);
+        timing.missedVBlanks = slot.missedVBlanks.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != before || timing.frameNumber != index) {
+            continue; // overwritten meanwhile by a newer frame
+        }
+
+        result.append(timing);
+    }
+
+    return result;
+}
+
+} // namespace qtmir
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_FRAMETIMINGS_H
+#define QTMIR_FRAMETIMINGS_H
+
+#include <QVector>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace qtmir {
+
+/*
+  Timings of one frame rendered to a Screen, all durations in nanoseconds.
+ */
+struct FrameTiming
+{
+    uint64_t frameNumber{0}; // assigned by FrameTimingRing::push
+    int64_t makeCurrent{0}; // time spent making the display buffer current
+    int64_t render{0};      // from the end of makeCurrent until swap_buffers is called
+    int64_t swap{0};        // swap_buffers
+    int64_t post{0};        // DisplaySyncGroup::post, usually blocks for vsync
+    int missedVBlanks{0};   // refresh periods skipped while this frame was being made, idle time not included
+};
+
+/*
+  Fixed-size ring of the most recent FrameTimings of a Screen.
+
+  The render thread of the Screen is the single writer and never blocks. Any other thread (usually
+  the GUI one) can take a snapshot of the ring at any time. Every slot is guarded by a sequence counter,
+  readers simply skip slots that were being overwritten while they were copied.
+ */
+class FrameTimingRing
+{
+public:
+    static const int Capacity = 128;
+
+    // Render thread only
+    void push(const FrameTiming &timing);
+
+    // Any thread. Returns up to maxCount of the most recent timings, oldest first.
+    QVector<FrameTiming> snapshot(int maxCount = Capacity) const;
+
+    uint64_t frameCount() const { return m_written.load(std::memory_order_acquire); }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint64_t> frameNumber{0};
+        std::atomic<int64_t> makeCurrent{0};
+        std::atomic<int64_t> render{0};
+        std::atomic<int64_t> swap{0};
+        std::atomic<int64_t> post{0};
+        std::atomic<int> missedVBlanks{0};
+    };
+
+    std::array<Slot, Capacity> m_slots;
+    std::atomic<uint64_t> m_written{0};
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_FRAMETIMINGS_H
@@ -15,33 +15,68 @@
  */
 
 #include "initialsurfacesizes.h"
+#include "procstat.h"
 
 #include <QMutexLocker>
 
-QMap<pid_t, QSize> InitialSurfaceSizes::sizeForSession;
-QMutex InitialSurfaceSizes::mutex;
+#include <atomic>
+
+std::shared_ptr<const InitialSurfaceSizes::Snapshot> InitialSurfaceSizes::snapshot{std::make_shared<Snapshot>()};
+QMutex InitialSurfaceSizes::writeMutex;
+quint64 InitialSurfaceSizes::nextSequence{0};
 
 void InitialSurfaceSizes::set(pid_t pid, const QSize &size)
 {
-    QMutexLocker locker(&mutex);
+    const quint64 startTime = qtmir::processStartTime(pid);
+
+    QMutexLocker locker(&writeMutex);
+
+    auto updated = std::make_shared<Snapshot>(*std::atomic_load(&snapshot));
+    (*updated)[pid] = Entry{startTime, nextSequence++, size};
 
-    sizeForSession[pid] = size;
+    if (updated->count() > MaxEntries) {
+        auto oldest = updated->begin();
+        for (auto it = updated->begin(); it != updated->end(); ++it) {
+            if (it->sequence < oldest->sequence) {
+                oldest = it;
+            }
+        }
+        updated->erase(oldest);
+    }
+
+    std::atomic_store(&snapshot, std::shared_ptr<const Snapshot>(updated));
 }
 
 void InitialSurfaceSizes::remove(pid_t pid)
 {
-    QMutexLocker locker(&mutex);
+    QMutexLocker locker(&writeMutex);
+
+    auto current = std::atomic_load(&snapshot);
+    if (!current->contains(pid)) {
+        return;
+    }
 
-    sizeForSession.remove(pid);
+    auto updated = std::make_shared<Snapshot>(*current);
+    updated->remove(pid);
+    std::atomic_store(&snapshot, std::shared_ptr<const Snapshot>(updated));
 }
 
 QSize InitialSurfaceSizes::get(pid_t pid)
 {
-    QMutexLocker locker(&mutex);
+    const auto current = std::atomic_load(&snapshot);
 
-    if (sizeForSession.contains(pid)) {
-        return sizeForSession[pid];
-    } else {
+    auto it = current->constFind(pid);
+    if (it == current->constEnd()) {
         return QSize();
     }
+
+    if (it->startTime != qtmir::processStartTime(pid)) {
+        return QSize(); // not the process it was set for
+    }
+    return it->size;
+}
+
+int InitialSurfaceSizes::count()
+{
+    return std::atomic_load(&snapshot)->count();
 }
@@ -15,21 +15,38 @@
  */
 
 #include <QMutex>
-#include <QMap>
+#include <QHash>
 #include <QSize>
 
+#include <memory>
+
 /*
   The size that the first frame of the first top-level surface of an application with the given pid should have.
 
-  Qt GUI thread fills it with data and mir/miral thread queries it
+  Qt GUI thread fills it with data and mir/miral thread queries it. Queries never wait for writers: they read an
+  immutable snapshot which writers replace. Entries are keyed by pid and process start time, so that a size set
+  for a process that is gone is never given to another one which got the same pid.
  */
 class InitialSurfaceSizes
 {
 public:
+    static const int MaxEntries = 64; // oldest ones are dropped beyond that
+
     static void set(pid_t, const QSize &);
     static void remove(pid_t);
     static QSize get(pid_t);
+
+    static int count();
+
 private:
-    static QMap<pid_t, QSize> sizeForSession;
-    static QMutex mutex;
+    struct Entry {
+        quint64 startTime;
+        quint64 sequence; // order of insertion, to drop the oldest
+        QSize size;
+    };
+    using Snapshot = QHash<pid_t, Entry>;
+
+    static std::shared_ptr<const Snapshot> snapshot;
+    static QMutex writeMutex;
+    static quint64 nextSequence;
 };
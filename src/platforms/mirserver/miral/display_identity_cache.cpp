@@ -0,0 +1,324 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "display_identity_cache.h"
+#include "edid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+#include <sys/stat.h>
+
+namespace
+{
+// One record per line:
+//   display <vendor> <product> <serial> <width> <height> <refresh> <scale> <orientation> <form factor>
+//   layout <count> then <vendor> <product> <serial> <x> <y> for each monitor
+char const* const file_header = "# qtmir display identities v2";
+
+// Display records only, without the record type
+char const* const v1_file_header = "# qtmir display identities v1";
+
+std::vector<miral::DisplayId> monitor_set(miral::DisplayLayout const& layout)
+{
+    std::vector<miral::DisplayId> monitors;
+    monitors.reserve(layout.size());
+    for (auto const& placement : layout) {
+        monitors.push_back(placement.id);
+    }
+    std::sort(monitors.begin(), monitors.end());
+    return monitors;
+}
+
+std::istream& operator>>(std::istream& in, miral::DisplayId& id)
+{
+    return in >> id.vendor >> id.product_code >> id.serial_number;
+}
+
+std::ostream& operator<<(std::ostream& out, miral::DisplayId const& id)
+{
+    return out << id.vendor << ' ' << id.product_code << ' ' << id.serial_number;
+}
+
+void make_parent_directories(std::string const& path)
+{
+    for (auto slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        mkdir(path.substr(0, slash).c_str(), 0700); // EEXIST is fine
+    }
+}
+}
+
+miral::DisplayId miral::DisplayId::from_edid(Edid const& edid)
+{
+    DisplayId id;
+    id.vendor = edid.vendor;
+    id.product_code = edid.product_code;
+    id.serial_number = edid.serial_number;
+    return id;
+}
+
+bool miral::DisplayId::operator==(DisplayId const& other) const
+{
+    return std::tie(vendor, product_code, serial_number)
+        == std::tie(other.vendor, other.product_code, other.serial_number);
+}
+
+bool miral::DisplayId::operator<(DisplayId const& other) const
+{
+    return std::tie(vendor, product_code, serial_number)
+        < std::tie(other.vendor, other.product_code, other.serial_number);
+}
+
+bool miral::DisplayPlacement::operator==(DisplayPlacement const& other) const
+{
+    return id == other.id && x == other.x && y == other.y;
+}
+
+bool miral::DisplaySettings::operator==(DisplaySettings const& other) const
+{
+    return width == other.width && height == other.height
+        && std::fabs(refresh_rate - other.refresh_rate) < 0.01
+        && std::fabs(scale - other.scale) < 0.001f
+        && orientation == other.orientation && form_factor == other.form_factor;
+}
+
+miral::DisplayIdentityCache::DisplayIdentityCache(std::string const& path) :
+    file_path{path}
+{
+}
+
+miral::DisplayId miral::DisplayIdentityCache::identify(std::vector<uint8_t> const& edid)
+{
+    if (edid.empty()) {
+        return {};
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const known = identities.find(edid);
+    if (known != identities.end()) {
+        return known->second;
+    }
+
+    DisplayId id;
+    try {
+        id = DisplayId::from_edid(Edid{}.parse_data(edid));
+    } catch (std::runtime_error const&) {
+        // Remember broken EDIDs too, so they are not parsed again
+    }
+    identities.emplace(edid, id);
+    return id;
+}
+
+bool miral::DisplayIdentityCache::lookup(DisplayId const& id, DisplaySettings& result) const
+{
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const known = settings.find(id);
+    if (known == settings.end()) {
+        return false;
+    }
+    result = known->second;
+    return true;
+}
+
+bool miral::DisplayIdentityCache::store(DisplayId const& id, DisplaySettings const& new_settings)
+{
+    if (!id.is_valid()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& stored = settings[id];
+    if (stored == new_settings) {
+        return false;
+    }
+    stored = new_settings;
+    return true;
+}
+
+bool miral::match_layout(DisplayLayout const& layout, std::vector<DisplayId> const& monitors, DisplayLayout& placements)
+{
+    if (layout.size() != monitors.size()) {
+        return false;
+    }
+
+    DisplayLayout matched;
+    matched.reserve(monitors.size());
+    std::vector<bool> taken(layout.size(), false);
+    for (auto const& id : monitors) {
+        size_t i = 0;
+        while (i < layout.size() && (taken[i] || layout[i].id != id)) {
+            ++i;
+        }
+        if (i == layout.size()) {
+            return false;
+        }
+        taken[i] = true;
+        matched.push_back(layout[i]);
+    }
+
+    placements = std::move(matched);
+    return true;
+}
+
+bool miral::DisplayIdentityCache::lookup_layout(std::vector<DisplayId> monitors, DisplayLayout& layout) const
+{
+    std::sort(monitors.begin(), monitors.end());
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto const known = layouts.find(monitors);
+    if (known == layouts.end()) {
+        return false;
+    }
+    layout = known->second;
+    return true;
+}
+
+bool miral::DisplayIdentityCache::store_layout(DisplayLayout const& layout)
+{
+    if (layout.empty()) {
+        return false;
+    }
+    for (auto const& placement : layout) {
+        if (!placement.id.is_valid()) {
+            return false;
+        }
+    }
+
+    auto const key = monitor_set(layout);
+
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& stored = layouts[key];
+    if (stored == layout) {
+        return false;
+    }
+    stored = layout;
+    return true;
+}
+
+void miral::DisplayIdentityCache::load()
+{
+    std::ifstream in{file_path};
+    if (!in) {
+        return;
+    }
+
+    std::map<DisplayId, DisplaySettings> loaded_settings;
+    std::map<std::vector<DisplayId>, DisplayLayout> loaded_layouts;
+    std::string line;
+    bool v1 = false;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            v1 |= line == v1_file_header;
+            continue;
+        }
+
+        std::istringstream fields{line};
+        std::string record{"display"};
+        if (!v1) {
+            fields >> record;
+        }
+
+        // skip corrupt entries rather than losing the whole file
+        if (record == "display") {
+            DisplayId id;
+            DisplaySettings value;
+            fields >> id >> value.width >> value.height >> value.refresh_rate
+                   >> value.scale >> value.orientation >> value.form_factor;
+            if (!fields.fail() && id.is_valid()) {
+                loaded_settings[id] = value;
+            }
+        } else if (record == "layout") {
+            size_t count = 0;
+            fields >> count;
+            DisplayLayout layout;
+            for (size_t i = 0; i < count && fields; ++i) {
+                DisplayPlacement placement;
+                fields >> placement.id >> placement.x >> placement.y;
+                layout.push_back(placement);
+            }
+            if (!fields.fail() && !layout.empty()) {
+                loaded_layouts[monitor_set(layout)] = layout;
+            }
+        }
+    }
+
+    // anything seen since startup is newer
+    std::lock_guard<std::mutex> lock{mutex};
+    settings.insert(loaded_settings.begin(), loaded_settings.end());
+    layouts.insert(loaded_layouts.begin(), loaded_layouts.end());
+}
+
+void miral::DisplayIdentityCache::save() const
+{
+    std::ostringstream out;
+    out << file_header << '\n';
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto const& entry : settings) {
+            auto const& value = entry.second;
+            out << "display " << entry.first << ' '
+                << value.width << ' ' << value.height << ' ' << value.refresh_rate << ' '
+                << value.scale << ' ' << value.orientation << ' ' << value.form_factor << '\n';
+        }
+        for (auto const& entry : layouts) {
+            out << "layout " << entry.second.size();
+            for (auto const& placement : entry.second) {
+                out << ' ' << placement.id << ' ' << placement.x << ' ' << placement.y;
+            }
+            out << '\n';
+        }
+    }
+
+    // Write to a temporary file and rename, so a crash never leaves a truncated file behind
+    make_parent_directories(file_path);
+    auto const temp_path = file_path + ".new";
+    {
+        std::ofstream file{temp_path, std::ios::trunc};
+        file << out.str();
+        if (!file.flush()) {
+            std::remove(temp_path.c_str());
+            throw std::runtime_error("Failed to write display configuration to " + temp_path);
+        }
+    }
+    if (std::rename(temp_path.c_str(), file_path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        throw std::runtime_error("Failed to replace " + file_path);
+    }
+}
+
+std::string miral::DisplayIdentityCache::default_path()
+{
+    std::string config_home;
+    if (auto const xdg_config_home = std::getenv("XDG_CONFIG_HOME")) {
+        config_home = xdg_config_home;
+    } else if (auto const home = std::getenv("HOME")) {
+        config_home = std::string{home} + "/.config";
+    } else {
+        config_home = "/tmp";
+    }
+    return config_home + "/qtmir/displays.conf";
+}
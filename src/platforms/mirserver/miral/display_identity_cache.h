@@ -0,0 +1,119 @@
+/*
+ * Copyright © 2017 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIRAL_DISPLAY_IDENTITY_CACHE_H
+#define MIRAL_DISPLAY_IDENTITY_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Prototyping namespace for later incorporation in MirAL
+namespace miral
+{
+struct Edid;
+
+/// Identifies a physical monitor across hot-plugs and reboots
+struct DisplayId
+{
+    std::string vendor;
+    uint16_t product_code{0};
+    uint32_t serial_number{0};
+
+    static DisplayId from_edid(Edid const& edid);
+
+    bool is_valid() const { return !vendor.empty(); }
+
+    bool operator==(DisplayId const& other) const;
+    bool operator!=(DisplayId const& other) const { return !(*this == other); }
+    bool operator<(DisplayId const& other) const;
+};
+
+/// The user visible settings of a monitor that are worth restoring
+struct DisplaySettings
+{
+    int width{0};
+    int height{0};
+    double refresh_rate{0};
+    float scale{1.0f};
+    int orientation{0};   // MirOrientation
+    int form_factor{0};   // MirFormFactor
+
+    bool operator==(DisplaySettings const& other) const;
+    bool operator!=(DisplaySettings const& other) const { return !(*this == other); }
+};
+
+/// Where a monitor was placed in the virtual desktop
+struct DisplayPlacement
+{
+    DisplayId id;
+    int x{0};
+    int y{0};
+
+    bool operator==(DisplayPlacement const& other) const;
+};
+
+/// Placements of every monitor of a set of monitors connected together
+using DisplayLayout = std::vector<DisplayPlacement>;
+
+/// The placement in \a layout of each of \a monitors, in the same order as \a monitors. Identical monitors
+/// share an identity, so they are told apart by the order they appear in both.
+/// Returns false if \a layout is not for exactly this set of monitors.
+bool match_layout(DisplayLayout const& layout, std::vector<DisplayId> const& monitors, DisplayLayout& placements);
+
+/// Last known settings of every monitor seen, keyed by its EDID identity, and last known layout of
+/// every set of monitors, persisted to disk.
+/// Each distinct EDID blob is parsed only once. All methods are thread-safe.
+class DisplayIdentityCache
+{
+public:
+    explicit DisplayIdentityCache(std::string const& path);
+
+    /// The identity of the monitor with the given EDID. Invalid if the EDID is empty or malformed.
+    DisplayId identify(std::vector<uint8_t> const& edid);
+
+    bool lookup(DisplayId const& id, DisplaySettings& settings) const;
+
+    /// Returns true if the stored settings changed
+    bool store(DisplayId const& id, DisplaySettings const& settings);
+
+    /// The layout last used with exactly this set of monitors, in any order
+    bool lookup_layout(std::vector<DisplayId> monitors, DisplayLayout& layout) const;
+
+    /// Returns true if the stored layout changed. Layouts with unidentified monitors are not stored.
+    bool store_layout(DisplayLayout const& layout);
+
+    void load();
+    void save() const;
+
+    std::string const& path() const { return file_path; }
+
+    /// $XDG_CONFIG_HOME/qtmir/displays.conf
+    static std::string default_path();
+
+private:
+    std::string const file_path;
+
+    mutable std::mutex mutex;
+    std::map<std::vector<uint8_t>, DisplayId> identities;
+    std::map<DisplayId, DisplaySettings> settings;
+    std::map<std::vector<DisplayId>, DisplayLayout> layouts; // keyed by the sorted monitor set
+};
+}
+
+#endif // MIRAL_DISPLAY_IDENTITY_CACHE_H
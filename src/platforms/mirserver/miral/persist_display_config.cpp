@@ -17,11 +17,22 @@
  */
 
 #include "persist_display_config.h"
+#include "display_identity_cache.h"
 
+#include <mir/graphics/display_configuration.h>
 #include <mir/graphics/display_configuration_policy.h>
+#include <mir/log.h>
 #include <mir/server.h>
 #include <mir/version.h>
 
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
 #if MIR_SERVER_VERSION >= MIR_VERSION_NUMBER(0, 26, 0)
 #include <mir/graphics/display_configuration_observer.h>
 #include <mir/observer_registrar.h>
@@ -33,15 +44,71 @@ namespace
 {
 struct PersistDisplayConfigPolicy
 {
-    PersistDisplayConfigPolicy() = default;
-    virtual ~PersistDisplayConfigPolicy() = default;
+    PersistDisplayConfigPolicy();
+    virtual ~PersistDisplayConfigPolicy();
     PersistDisplayConfigPolicy(PersistDisplayConfigPolicy const&) = delete;
     auto operator=(PersistDisplayConfigPolicy const&) -> PersistDisplayConfigPolicy& = delete;
 
     void apply_to(mg::DisplayConfiguration& conf, mg::DisplayConfigurationPolicy& default_policy);
     void save_config(mg::DisplayConfiguration const& base_conf);
+
+private:
+    void apply_saved_settings(mg::DisplayConfiguration& conf);
+    void save_until_up_to_date();
+
+    miral::DisplayIdentityCache cache{miral::DisplayIdentityCache::default_path()};
+
+    // At most one save runs at a time. Changes made meanwhile are picked up by another pass of that same save.
+    std::mutex saving_mutex;
+    bool saving{false};
+    bool save_again{false};
+    std::future<void> saver;
 };
 
+// Lays out the used outputs side by side, keeping their current left to right order
+void relayout_side_by_side(mg::DisplayConfiguration& conf)
+{
+    std::vector<std::pair<int, mg::DisplayConfigurationOutputId>> order;
+    conf.for_each_output(
+        [&](mg::DisplayConfigurationOutput const& output)
+        {
+            if (output.connected && output.used) {
+                order.emplace_back(output.top_left.x.as_int(), output.id);
+            }
+        });
+    std::stable_sort(order.begin(), order.end(),
+                     [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+
+    std::map<mg::DisplayConfigurationOutputId, int> rank;
+    for (size_t i = 0; i < order.size(); ++i) {
+        rank[order[i].second] = static_cast<int>(i);
+    }
+
+    std::vector<int> widths(order.size(), 0);
+    conf.for_each_output(
+        [&](mg::UserDisplayConfigurationOutput& output)
+        {
+            auto const r = rank.find(output.id);
+            if (r != rank.end()) {
+                widths[r->second] = output.extents().size.width.as_int();
+            }
+        });
+
+    conf.for_each_output(
+        [&](mg::UserDisplayConfigurationOutput& output)
+        {
+            auto const r = rank.find(output.id);
+            if (r == rank.end()) {
+                return;
+            }
+            int x = 0;
+            for (int i = 0; i < r->second; ++i) {
+                x += widths[i];
+            }
+            output.top_left = mir::geometry::Point{x, 0};
+        });
+}
+
 struct DisplayConfigurationPolicyAdapter : mg::DisplayConfigurationPolicy
 {
     DisplayConfigurationPolicyAdapter(
@@ -136,16 +203,188 @@ void miral::PersistDisplayConfig::operator()(mir::Server& server)
 #endif
 }
 
+// Loaded while the server is being set up, before any display configuration is applied: the first one
+// already uses the saved settings, and no configuration ever waits for the file.
+PersistDisplayConfigPolicy::PersistDisplayConfigPolicy()
+{
+    cache.load();
+}
+
+PersistDisplayConfigPolicy::~PersistDisplayConfigPolicy()
+{
+    std::future<void> last_saver;
+    {
+        std::lock_guard<std::mutex> lock{saving_mutex};
+        last_saver = std::move(saver);
+    }
+    if (last_saver.valid()) {
+        last_saver.wait();
+    }
+}
+
 void PersistDisplayConfigPolicy::apply_to(
     mg::DisplayConfiguration& conf,
     mg::DisplayConfigurationPolicy& default_policy)
 {
-    // TODO if the h/w profile (by some definition) has changed, then apply corresponding saved config (if any).
-    // TODO Otherwise...
     default_policy.apply_to(conf);
+
+    // This runs for the initial configuration too, so the first frame is already rendered with the
+    // saved layout and the shell has no reason to reconfigure (and restart the compositor) at startup.
+    apply_saved_settings(conf);
+}
+
+void PersistDisplayConfigPolicy::apply_saved_settings(mg::DisplayConfiguration& conf)
+{
+    std::map<mg::DisplayConfigurationOutputId, miral::DisplaySettings> saved;
+    std::vector<mg::DisplayConfigurationOutputId> monitor_outputs;
+    std::vector<miral::DisplayId> monitors;
+    bool all_identified = true;
+    conf.for_each_output(
+        [&](mg::DisplayConfigurationOutput const& output)
+        {
+            if (!output.connected || !output.used) {
+                return;
+            }
+            auto const id = cache.identify(output.edid);
+            all_identified &= id.is_valid();
+            monitor_outputs.push_back(output.id);
+            monitors.push_back(id);
+
+            miral::DisplaySettings settings;
+            if (cache.lookup(id, settings)) {
+                saved[output.id] = settings;
+            }
+        });
+
+    if (saved.empty()) {
+        return;
+    }
+
+    // Outputs are listed in the same order as when the layout was saved, which tells identical monitors apart
+    miral::DisplayLayout layout;
+    miral::DisplayLayout placements;
+    bool const has_layout = all_identified
+        && cache.lookup_layout(monitors, layout)
+        && miral::match_layout(layout, monitors, placements);
+
+    bool extents_changed = false;
+    conf.for_each_output(
+        [&](mg::UserDisplayConfigurationOutput& output)
+        {
+            auto const entry = saved.find(output.id);
+            if (entry == saved.end()) {
+                return;
+            }
+            auto const& settings = entry->second;
+
+            // Pick the mode of the saved size with the closest refresh rate
+            int best_mode = -1;
+            for (size_t i = 0; i < output.modes.size(); ++i) {
+                auto const& mode = output.modes[i];
+                if (mode.size.width.as_int() != settings.width || mode.size.height.as_int() != settings.height) {
+                    continue;
+                }
+                if (best_mode < 0 || std::fabs(mode.vrefresh_hz - settings.refresh_rate)
+                        < std::fabs(output.modes[best_mode].vrefresh_hz - settings.refresh_rate)) {
+                    best_mode = static_cast<int>(i);
+                }
+            }
+
+            if (best_mode >= 0 && output.current_mode_index != static_cast<size_t>(best_mode)) {
+                output.current_mode_index = best_mode;
+                extents_changed = true;
+            }
+            if (output.orientation != static_cast<MirOrientation>(settings.orientation)) {
+                output.orientation = static_cast<MirOrientation>(settings.orientation);
+                extents_changed = true;
+            }
+            output.scale = settings.scale;
+            output.form_factor = static_cast<MirFormFactor>(settings.form_factor);
+        });
+
+    if (has_layout) {
+        conf.for_each_output(
+            [&](mg::UserDisplayConfigurationOutput& output)
+            {
+                auto const monitor = std::find(monitor_outputs.begin(), monitor_outputs.end(), output.id);
+                if (monitor == monitor_outputs.end()) {
+                    return;
+                }
+                auto const& placement = placements[monitor - monitor_outputs.begin()];
+                output.top_left = mir::geometry::Point{placement.x, placement.y};
+            });
+    } else if (extents_changed) {
+        relayout_side_by_side(conf);
+    }
+}
+
+void PersistDisplayConfigPolicy::save_config(mg::DisplayConfiguration const& base_conf)
+{
+    bool changed = false;
+    bool all_identified = true;
+    miral::DisplayLayout layout;
+    base_conf.for_each_output(
+        [&](mg::DisplayConfigurationOutput const& output)
+        {
+            if (!output.connected || !output.used || output.current_mode_index >= output.modes.size()) {
+                return;
+            }
+
+            auto const id = cache.identify(output.edid);
+            if (!id.is_valid()) {
+                all_identified = false;
+                return;
+            }
+
+            miral::DisplayPlacement placement;
+            placement.id = id;
+            placement.x = output.top_left.x.as_int();
+            placement.y = output.top_left.y.as_int();
+            layout.push_back(placement);
+
+            auto const& mode = output.modes[output.current_mode_index];
+            miral::DisplaySettings settings;
+            settings.width = mode.size.width.as_int();
+            settings.height = mode.size.height.as_int();
+            settings.refresh_rate = mode.vrefresh_hz;
+            settings.scale = output.scale;
+            settings.orientation = output.orientation;
+            settings.form_factor = output.form_factor;
+
+            changed |= cache.store(id, settings);
+        });
+
+    if (all_identified) {
+        changed |= cache.store_layout(layout);
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    // Don't hold up the display configuration on disk I/O, nor on a previous save still writing
+    std::lock_guard<std::mutex> lock{saving_mutex};
+    if (saving) {
+        save_again = true;
+        return;
+    }
+    saving = true;
+    // The previous saver, if any, is past its last pass: replacing it does not wait for disk I/O
+    saver = std::async(std::launch::async, [this] { save_until_up_to_date(); });
 }
 
-void PersistDisplayConfigPolicy::save_config(mg::DisplayConfiguration const& /*base_conf*/)
+void PersistDisplayConfigPolicy::save_until_up_to_date()
 {
-    // TODO save display config options against the h/w profile
+    std::unique_lock<std::mutex> lock{saving_mutex};
+    do {
+        save_again = false;
+        lock.unlock();
+        try {
+            cache.save();
+        } catch (std::exception const& error) {
+            mir::log_warning("Failed to save display configuration: %s", error.what());
+        }
+        lock.lock();
+    } while (save_again);
+    saving = false;
 }
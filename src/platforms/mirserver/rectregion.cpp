@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rectregion.h"
+
+#include <algorithm>
+
+namespace qtmir {
+
+RectRegion::RectRegion(const QVector<QRect> &rects)
+{
+    QVector<int> edges;
+    for (const QRect &rect : rects) {
+        if (rect.isEmpty()) {
+            continue;
+        }
+        m_rects.append(rect);
+        m_boundingRect |= rect;
+        edges.append(rect.top());
+        edges.append(rect.bottom() + 1);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    m_bands.reserve(edges.count());
+    for (const int top : edges) {
+        m_bands.append({top, {}, {}});
+    }
+
+    for (int i = 0; i < m_rects.count(); ++i) {
+        const QRect &rect = m_rects[i];
+        for (int band = bandAt(rect.top()); m_bands[band].top <= rect.bottom(); ++band) {
+            m_bands[band].rectIndices.append(i);
+            m_bands[band].spans.append({rect.left(), rect.right()});
+        }
+    }
+
+    // merge the spans of each band
+    for (Band &band : m_bands) {
+        auto &spans = band.spans;
+        std::sort(spans.begin(), spans.end());
+        int merged = 0;
+        for (int i = 1; i < spans.count(); ++i) {
+            if (spans[i].first <= spans[merged].second + 1) {
+                spans[merged].second = std::max(spans[merged].second, spans[i].second);
+            } else {
+                spans[++merged] = spans[i];
+            }
+        }
+        spans.resize(spans.isEmpty() ? 0 : merged + 1);
+    }
+}
+
+// The band containing y, -1 if y is above all of them
+int RectRegion::bandAt(int y) const
+{
+    auto after = std::upper_bound(m_bands.begin(), m_bands.end(), y,
+                                  [](int y, const Band &band) { return y < band.top; });
+    return static_cast<int>(after - m_bands.begin()) - 1;
+}
+
+bool RectRegion::contains(const QPoint &point) const
+{
+    const int band = bandAt(point.y());
+    if (band < 0) {
+        return false;
+    }
+
+    const auto &spans = m_bands[band].spans;
+    auto after = std::upper_bound(spans.begin(), spans.end(), point.x(),
+                                  [](int x, const QPair<int, int> &span) { return x < span.first; });
+    return after != spans.begin() && point.x() <= (after - 1)->second;
+}
+
+QVector<int> RectRegion::intersecting(const QRect &rect) const
+{
+    QVector<int> result;
+    if (rect.isEmpty() || !m_boundingRect.intersects(rect)) {
+        return result;
+    }
+
+    for (int band = std::max(bandAt(rect.top()), 0); band < m_bands.count() && m_bands[band].top <= rect.bottom(); ++band) {
+        for (const int i : m_bands[band].rectIndices) {
+            if (m_rects[i].intersects(rect)) {
+                result.append(i);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+QRect RectRegion::largestOverlapWith(const QRect &rect) const
+{
+    QRect best;
+    qint64 bestArea = 0;
+    for (const int i : intersecting(rect)) {
+        const QRect overlap = m_rects[i] & rect;
+        const qint64 area = static_cast<qint64>(overlap.width()) * overlap.height();
+        if (area > bestArea) {
+            best = m_rects[i];
+            bestArea = area;
+        }
+    }
+    return best;
+}
+
+} // namespace qtmir
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QTMIR_RECTREGION_H
+#define QTMIR_RECTREGION_H
+
+#include <QPair>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+
+namespace qtmir {
+
+/*
+  An immutable set of possibly overlapping rectangles, indexed for hit testing.
+
+  The plane is cut into horizontal bands at every top and bottom edge. Each band knows which rectangles span it
+  and the disjoint horizontal spans they cover, so a point lookup is two binary searches, O(log n), and a
+  rectangle lookup only visits the bands it crosses.
+ */
+class RectRegion
+{
+public:
+    RectRegion() = default;
+    explicit RectRegion(const QVector<QRect> &rects);
+
+    bool isEmpty() const { return m_rects.isEmpty(); }
+    const QVector<QRect> &rects() const { return m_rects; }
+    QRect boundingRect() const { return m_boundingRect; }
+
+    bool contains(const QPoint &point) const;
+
+    // Indices in rects() of the rectangles intersecting rect, in ascending order
+    QVector<int> intersecting(const QRect &rect) const;
+
+    // The rectangle sharing the largest area with rect, the first one on a tie. Null if none intersects it.
+    QRect largestOverlapWith(const QRect &rect) const;
+
+    bool operator==(const RectRegion &other) const { return m_rects == other.m_rects; }
+    bool operator!=(const RectRegion &other) const { return !(*this == other); }
+
+private:
+    struct Band {
+        int top; // the band ends where the next one starts
+        QVector<QPair<int, int>> spans; // disjoint [left, right] ranges, sorted
+        QVector<int> rectIndices;
+    };
+
+    int bandAt(int y) const;
+
+    QVector<QRect> m_rects;
+    QRect m_boundingRect;
+    QVector<Band> m_bands; // sorted by top, the last one is always empty
+};
+
+} // namespace qtmir
+
+#endif // QTMIR_RECTREGION_H
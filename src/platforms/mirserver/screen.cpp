@@ -18,6 +18,7 @@
 #include "screen.h"
 #include "logging.h"
 #include "nativeinterface.h"
+#include "tracepoints.h" // generated from tracepoints.tp
 
 // Mir
 #include "mir/geometry/size.h"
@@ -34,10 +35,13 @@
 #include <QtMath>
 
 // Qt sensors
-#include <QtSensors/QOrientationReading>
 #include <QtSensors/QOrientationSensor>
 
 namespace mg = mir::geometry;
+using Clock = std::chrono::steady_clock;
+
+#define ENV_ORIENTATION_HYSTERESIS_MS "QTMIR_ORIENTATION_HYSTERESIS_MS"
+#define DEFAULT_ORIENTATION_HYSTERESIS_MS 200
 
 namespace {
 bool isLittleEndian() {
@@ -147,7 +151,9 @@ Screen::Screen(const mir::graphics::DisplayConfigurationOutput &screen)
     , m_formFactor(mir_form_factor_unknown)
     , m_renderTarget(nullptr)
     , m_displayGroup(nullptr)
-    , m_orientationSensor(new QOrientationSensor(this))
+    , m_orientationSensor(nullptr)
+    , m_lastPostedReading(QOrientationReading::Undefined)
+    , m_settlingReading(QOrientationReading::Undefined)
     , m_screenWindow(nullptr)
     , m_unityScreen(nullptr)
 {
@@ -163,7 +169,14 @@ Screen::Screen(const mir::graphics::DisplayConfigurationOutput &screen)
             ? Qt::LandscapeOrientation : Qt::PortraitOrientation;
     qCDebug(QTMIR_SENSOR_MESSAGES) << "Screen - initial currentOrientation is:" << m_currentOrientation;
 
-    if (internalDisplay()) { // only enable orientation sensor for device-internal display
+    bool ok;
+    int hysteresis = qgetenv(ENV_ORIENTATION_HYSTERESIS_MS).toInt(&ok);
+    m_orientationSettleTimer.setSingleShot(true);
+    setOrientationHysteresis(ok ? hysteresis : DEFAULT_ORIENTATION_HYSTERESIS_MS);
+    QObject::connect(&m_orientationSettleTimer, &QTimer::timeout, this, &Screen::applyOrientationReading);
+
+    if (internalDisplay()) { // only create an orientation sensor for device-internal display
+        m_orientationSensor = new QOrientationSensor(this);
         QObject::connect(m_orientationSensor, &QOrientationSensor::readingChanged,
                          this, &Screen::onOrientationReadingChanged);
         m_orientationSensor->start();
@@ -195,7 +208,12 @@ Screen::~Screen()
 
 bool Screen::orientationSensorEnabled()
 {
-    return m_orientationSensor->isActive();
+    return m_orientationSensor && m_orientationSensor->isActive();
+}
+
+void Screen::setOrientationHysteresis(int msecs)
+{
+    m_orientationSettleTimer.setInterval(qMax(0, msecs));
 }
 
 void Screen::onDisplayPowerStateChanged(int status, int reason)
@@ -284,6 +302,10 @@ void Screen::setMirDisplayConfiguration(const mir::graphics::DisplayConfiguratio
 void Screen::toggleSensors(const bool enable) const
 {
     qCDebug(QTMIR_SENSOR_MESSAGES) << "Screen::toggleSensors - enable=" << enable;
+    if (!m_orientationSensor) {
+        return;
+    }
+
     if (enable) {
         m_orientationSensor->start();
     } else {
@@ -293,49 +315,88 @@ void Screen::toggleSensors(const bool enable) const
 
 void Screen::customEvent(QEvent* event)
 {
-    OrientationReadingEvent* oReadingEvent = static_cast<OrientationReadingEvent*>(event);
-    switch (oReadingEvent->m_orientation) {
+    if (event->type() != OrientationReadingEvent::m_type) {
+        QObject::customEvent(event);
+        return;
+    }
+
+    m_settlingReading = static_cast<OrientationReadingEvent*>(event)->m_orientation;
+    event->accept();
+
+    // (Re)start settling, a reading superseded before the interval elapses is never applied
+    if (m_orientationSettleTimer.interval() > 0) {
+        m_orientationSettleTimer.start();
+    } else {
+        applyOrientationReading();
+    }
+}
+
+void Screen::applyOrientationReading()
+{
+    Qt::ScreenOrientation newOrientation;
+    switch (m_settlingReading) {
         case QOrientationReading::LeftUp: {
-            m_currentOrientation = (m_nativeOrientation == Qt::LandscapeOrientation) ?
+            newOrientation = (m_nativeOrientation == Qt::LandscapeOrientation) ?
                         Qt::InvertedPortraitOrientation : Qt::LandscapeOrientation;
             break;
         }
         case QOrientationReading::TopUp: {
-            m_currentOrientation = (m_nativeOrientation == Qt::LandscapeOrientation) ?
+            newOrientation = (m_nativeOrientation == Qt::LandscapeOrientation) ?
                         Qt::LandscapeOrientation : Qt::PortraitOrientation;
             break;
         }
         case QOrientationReading::RightUp: {
-            m_currentOrientation = (m_nativeOrientation == Qt::LandscapeOrientation) ?
+            newOrientation = (m_nativeOrientation == Qt::LandscapeOrientation) ?
                         Qt::PortraitOrientation : Qt::InvertedLandscapeOrientation;
             break;
         }
         case QOrientationReading::TopDown: {
-            m_currentOrientation = (m_nativeOrientation == Qt::LandscapeOrientation) ?
+            newOrientation = (m_nativeOrientation == Qt::LandscapeOrientation) ?
                         Qt::InvertedLandscapeOrientation : Qt::InvertedPortraitOrientation;
             break;
         }
         default: {
             qWarning("Unknown orientation.");
-            event->accept();
             return;
         }
     }
 
+    if (newOrientation == m_currentOrientation) {
+        return;
+    }
+    m_currentOrientation = newOrientation;
+
     // Raise the event signal so that client apps know the orientation changed
     QWindowSystemInterface::handleScreenOrientationChange(screen(), m_currentOrientation);
-    event->accept();
-    qCDebug(QTMIR_SENSOR_MESSAGES) << "Screen::customEvent - new orientation" << m_currentOrientation << "handled";
+    qCDebug(QTMIR_SENSOR_MESSAGES) << "Screen::applyOrientationReading - new orientation" << m_currentOrientation << "handled";
 }
 
 void Screen::onOrientationReadingChanged()
 {
     qCDebug(QTMIR_SENSOR_MESSAGES) << "Screen::onOrientationReadingChanged";
 
+    onOrientationReading(m_orientationSensor->reading()->orientation());
+}
+
+void Screen::onOrientationReading(QOrientationReading::Orientation reading)
+{
+    switch (reading) {
+    case QOrientationReading::TopUp:
+    case QOrientationReading::TopDown:
+    case QOrientationReading::LeftUp:
+    case QOrientationReading::RightUp:
+        break;
+    default:
+        // Lying flat or unknown, keep the current orientation
+        return;
+    }
+
+    if (m_lastPostedReading.exchange(reading) == reading) {
+        return;
+    }
+
     // Make sure to switch to the main Qt thread context
-    QCoreApplication::postEvent(this, new OrientationReadingEvent(
-                                              OrientationReadingEvent::m_type,
-                                              m_orientationSensor->reading()->orientation()));
+    QCoreApplication::postEvent(this, new OrientationReadingEvent(OrientationReadingEvent::m_type, reading));
 }
 
 QPlatformCursor *Screen::cursor() const
@@ -385,7 +446,9 @@ void Screen::setMirDisplayBuffer(mir::graphics::DisplayBuffer *buffer, mir::grap
 
 void Screen::swapBuffers()
 {
+    const auto swapStartTime = Clock::now();
     m_renderTarget->swap_buffers();
+    const auto postStartTime = Clock::now();
 
     /* FIXME this exposes a QtMir architecture problem, as Screen is supposed to wrap a mg::DisplayBuffer.
      * We use Qt's multithreaded renderer, where each Screen is rendered to relatively independently, and
@@ -399,16 +462,61 @@ void Screen::swapBuffers()
      * Integrating the Qt Scenegraph renderer as a Mir renderer should solve this issue.
      */
     m_displayGroup->post();
+    const auto postEndTime = Clock::now();
+
+    recordFrameTiming(swapStartTime, postStartTime, postEndTime);
 }
 
 void Screen::makeCurrent()
 {
+    const auto makeCurrentStartTime = Clock::now();
+    if (m_frameStartTime == Clock::time_point()) {
+        m_frameStartTime = makeCurrentStartTime;
+    }
     m_renderTarget->make_current();
+    m_renderStartTime = Clock::now();
+    m_makeCurrentDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                m_renderStartTime - makeCurrentStartTime).count();
+}
+
+void Screen::recordFrameTiming(Clock::time_point swapStartTime,
+                               Clock::time_point postStartTime,
+                               Clock::time_point postEndTime)
+{
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+
+    qtmir::FrameTiming timing;
+    timing.makeCurrent = m_makeCurrentDuration;
+    timing.render = duration_cast<nanoseconds>(swapStartTime - m_renderStartTime).count();
+    timing.swap = duration_cast<nanoseconds>(postStartTime - swapStartTime).count();
+    timing.post = duration_cast<nanoseconds>(postEndTime - postStartTime).count();
+
+    // Any whole refresh period the frame took beyond the first one is a missed vblank. Counted from when the
+    // frame was started rather than from the previous post, frames are only made on demand and the screen
+    // may have been idle for long in between.
+    if (m_refreshRate > 0 && m_frameStartTime != Clock::time_point()) {
+        const double period = 1e9 / m_refreshRate;
+        const double pending = duration_cast<nanoseconds>(postEndTime - m_frameStartTime).count();
+        timing.missedVBlanks = qMax(0, qRound(pending / period) - 1);
+    }
+    m_frameStartTime = Clock::time_point();
+
+    m_frameTimings.push(timing);
+
+    tracepoint(qtmirserver, screenFrameTiming, static_cast<int>(m_outputId.as_value()),
+               timing.makeCurrent, timing.render, timing.swap, timing.post, timing.missedVBlanks);
+}
+
+QVector<qtmir::FrameTiming> Screen::frameTimings(int maxCount) const
+{
+    return m_frameTimings.snapshot(maxCount);
 }
 
 void Screen::doneCurrent()
 {
     m_renderTarget->release_current();
+    m_frameStartTime = Clock::time_point(); // released without posting, nothing was pending
 }
 
 bool Screen::internalDisplay() const
@@ -24,11 +24,19 @@
 #include <QtDBus/QDBusInterface>
 #include <qpa/qplatformscreen.h>
 
+// Qt sensors
+#include <QtSensors/QOrientationReading>
+
+// std
+#include <atomic>
+#include <chrono>
+
 // Mir
 #include <mir_toolkit/common.h>
 
 // local
 #include "cursor.h"
+#include "frametimings.h"
 #include "screenwindow.h"
 #include "screentypes.h"
 
@@ -66,6 +74,9 @@ public:
 
     ScreenWindow* window() const;
 
+    // Thread-safe, can be called from any thread while the render thread draws
+    QVector<qtmir::FrameTiming> frameTimings(int maxCount = qtmir::FrameTimingRing::Capacity) const;
+
     // QObject methods.
     void customEvent(QEvent* event) override;
 
@@ -73,6 +84,11 @@ public:
     static bool skipDBusRegistration;
     bool orientationSensorEnabled();
 
+    // How long (in ms) a new orientation reading has to persist before the screen is rotated.
+    // Defaults to $QTMIR_ORIENTATION_HYSTERESIS_MS, or 200ms
+    int orientationHysteresis() const { return m_orientationSettleTimer.interval(); }
+    void setOrientationHysteresis(int msecs);
+
 public Q_SLOTS:
    void onDisplayPowerStateChanged(int, int);
    void onOrientationReadingChanged();
@@ -87,6 +103,11 @@ protected:
     void doneCurrent();
 
 private:
+    void onOrientationReading(QOrientationReading::Orientation reading);
+    void applyOrientationReading();
+    void recordFrameTiming(std::chrono::steady_clock::time_point swapStartTime,
+                           std::chrono::steady_clock::time_point postStartTime,
+                           std::chrono::steady_clock::time_point postEndTime);
     void toggleSensors(const bool enable) const;
     bool internalDisplay() const;
 
@@ -108,15 +129,29 @@ private:
 
     Qt::ScreenOrientation m_nativeOrientation;
     Qt::ScreenOrientation m_currentOrientation;
-    QOrientationSensor *m_orientationSensor;
+    QOrientationSensor *m_orientationSensor; // only for internal displays
+
+    // Readings are debounced on the GUI thread: the last one received is only applied after
+    // settling for the hysteresis interval. Readings equal to the last one posted are dropped
+    // by the sensor thread already.
+    std::atomic<int> m_lastPostedReading;
+    QOrientationReading::Orientation m_settlingReading;
+    QTimer m_orientationSettleTimer;
 
     ScreenWindow *m_screenWindow;
     QDBusInterface *m_unityScreen;
 
     QScopedPointer<qtmir::Cursor> m_cursor;
 
+    // Only touched by the render thread, except for m_frameTimings
+    std::chrono::steady_clock::time_point m_frameStartTime; // first makeCurrent of the frame not posted yet
+    std::chrono::steady_clock::time_point m_renderStartTime;
+    int64_t m_makeCurrentDuration{0};
+    qtmir::FrameTimingRing m_frameTimings;
+
     friend class ScreensModel;
     friend class ScreenWindow;
+    friend class ScreenTest; // feeds orientation readings and frames
 };
 
 #endif // SCREEN_H
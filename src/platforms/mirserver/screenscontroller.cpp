@@ -15,6 +15,7 @@
  */
 
 #include "screenscontroller.h"
+#include "logging.h"
 #include "screen.h"
 #include "screensmodel.h"
 
@@ -34,11 +35,18 @@ ScreensController::ScreensController(const QSharedPointer<ScreensModel> &model,
     , m_screensModel(model)
     , m_display(display)
     , m_displayConfigurationController(controller)
+    , m_transactionDepth(0)
 {
+    connect(m_screensModel.data(), &ScreensModel::screenAdded, this, &ScreensController::onScreensChanged);
+    connect(m_screensModel.data(), &ScreensModel::screenRemoved, this, &ScreensController::onScreensChanged);
 }
 
 CustomScreenConfigurationList ScreensController::configuration()
 {
+    if (inTransaction()) {
+        return m_pendingConfiguration;
+    }
+
     CustomScreenConfigurationList list;
 
     Q_FOREACH(auto screen, m_screensModel->screens()) {
@@ -57,18 +65,87 @@ CustomScreenConfigurationList ScreensController::configuration()
 }
 
 bool ScreensController::setConfiguration(const CustomScreenConfigurationList &newConfig)
+{
+    if (!inTransaction()) {
+        return applyConfiguration(newConfig);
+    }
+
+    Q_FOREACH (const auto &config, newConfig) {
+        for (auto &pending : m_pendingConfiguration) {
+            if (pending.id == config.id) {
+                pending = config;
+            }
+        }
+    }
+    return true;
+}
+
+void ScreensController::beginConfiguration()
+{
+    if (!inTransaction()) {
+        m_pendingConfiguration = configuration();
+    }
+    ++m_transactionDepth;
+}
+
+bool ScreensController::commitConfiguration()
+{
+    if (!inTransaction()) {
+        qCWarning(QTMIR_SCREENS) << "ScreensController::commitConfiguration - no transaction to commit";
+        return false;
+    }
+
+    if (--m_transactionDepth > 0) {
+        return true;
+    }
+
+    CustomScreenConfigurationList pending;
+    pending.swap(m_pendingConfiguration);
+    return applyConfiguration(pending);
+}
+
+void ScreensController::abortConfiguration()
+{
+    if (!inTransaction()) {
+        return;
+    }
+
+    m_transactionDepth = 0;
+    m_pendingConfiguration.clear();
+}
+
+void ScreensController::onScreensChanged()
+{
+    if (!inTransaction()) {
+        return;
+    }
+
+    qCWarning(QTMIR_SCREENS) << "ScreensController - screens changed, dropping the pending configuration";
+    abortConfiguration();
+}
+
+bool ScreensController::applyConfiguration(const CustomScreenConfigurationList &newConfig)
 {
     using namespace mir::geometry;
 
     auto displayConfiguration = m_display->configuration();
+    bool changed = false;
 
     Q_FOREACH (const auto &config, newConfig) {
         displayConfiguration->for_each_output(
-            [&config](mg::UserDisplayConfigurationOutput &outputConfig)
+            [&config, &changed](mg::UserDisplayConfigurationOutput &outputConfig)
             {
                 if (config.id == outputConfig.id) {
+                    const Point topLeft{ X{config.topLeft.x()}, Y{config.topLeft.y()}};
+                    changed = changed
+                            || outputConfig.current_mode_index != config.currentModeIndex
+                            || outputConfig.top_left != topLeft
+                            || outputConfig.power_mode != config.powerMode
+                            || !qFuzzyCompare(outputConfig.scale, config.scale)
+                            || outputConfig.form_factor != config.formFactor;
+
                     outputConfig.current_mode_index = config.currentModeIndex;
-                    outputConfig.top_left = Point{ X{config.topLeft.x()}, Y{config.topLeft.y()}};
+                    outputConfig.top_left = topLeft;
                     outputConfig.power_mode = config.powerMode;
 //                    outputConfig.orientation = config.orientation; // disabling for now
                     outputConfig.scale = config.scale;
@@ -81,6 +158,12 @@ bool ScreensController::setConfiguration(const CustomScreenConfigurationList &ne
         return false;
     }
 
+    // The restored configuration is usually what the shell asks for at startup, applying it
+    // again would only stop and restart the compositor for nothing.
+    if (!changed) {
+        return true;
+    }
+
     m_displayConfigurationController->set_base_configuration(std::move(displayConfiguration));
     return true;
 }
@@ -48,10 +48,27 @@ public:
     CustomScreenConfigurationList configuration();
     bool setConfiguration(const CustomScreenConfigurationList &newConfig);
 
+    // Batches the setConfiguration calls made until the matching commit into one display configuration
+    // change, so the compositor is only stopped & restarted once. Transactions can nest, the outermost
+    // commit applies the changes. Meanwhile configuration() returns the pending configuration.
+    // Aborting drops the whole transaction however deeply nested, so a caller that bailed out before
+    // its commit does not block every later change. So does any screen being added or removed, as the
+    // pending configuration no longer matches the outputs.
+    void beginConfiguration();
+    bool commitConfiguration();
+    void abortConfiguration();
+    bool inTransaction() const { return m_transactionDepth > 0; }
+
 private:
+    bool applyConfiguration(const CustomScreenConfigurationList &newConfig);
+    void onScreensChanged();
+
     const QSharedPointer<ScreensModel> m_screensModel;
     const std::shared_ptr<mir::graphics::Display> m_display;
     const std::shared_ptr<mir::shell::DisplayConfigurationController> m_displayConfigurationController;
+
+    int m_transactionDepth;
+    CustomScreenConfigurationList m_pendingConfiguration;
 };
 
 #endif // SCREENSCONTROLLER_H
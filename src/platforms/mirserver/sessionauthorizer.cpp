@@ -19,11 +19,14 @@
 #include "tracepoints.h" // generated from tracepoints.tp
 
 #include <QMetaMethod>
-#include <QThread>
+
+namespace {
+const std::chrono::seconds listenerTimeout{1};
+}
 
 SessionAuthorizer::SessionAuthorizer(QObject *parent)
     : QObject(parent)
-    , m_connectionChecked(false)
+    , m_listenerReady(false)
 {
 }
 
@@ -37,17 +40,14 @@ bool SessionAuthorizer::connection_is_allowed(miral::ApplicationCredentials cons
     qCDebug(QTMIR_MIR_MESSAGES) << "SessionAuthorizer::connection_is_allowed - this=" << this << "pid=" << creds.pid();
     bool authorized = true;
 
-    if (!m_connectionChecked) {
+    if (!m_listenerReady) {
         // Wait until the ApplicationManager is ready to receive requestAuthorizationForSession signals
-        QMetaMethod mm = QMetaMethod::fromSignal(&SessionAuthorizer::requestAuthorizationForSession);
-        for (int i = 0; i < 100 && !isSignalConnected(mm); ++i) {
-            QThread::usleep(10000);
-        }
-        if (!isSignalConnected(mm)) {
+        std::unique_lock<std::mutex> lock(m_listenerMutex);
+        if (!m_listenerConnected.wait_for(lock, listenerTimeout, [this] { return m_listenerReady.load(); })) {
             qCDebug(QTMIR_MIR_MESSAGES) <<
                 "SessionAuthorizer::connection_is_allowed - Gave up waiting for signal listeners";
+            m_listenerReady = true;
         }
-        m_connectionChecked = true;
     }
 
     Q_EMIT requestAuthorizationForSession(creds.pid(), authorized); // needs to block until authorized value returned
@@ -56,6 +56,15 @@ bool SessionAuthorizer::connection_is_allowed(miral::ApplicationCredentials cons
     return authorized;
 }
 
+void SessionAuthorizer::connectNotify(const QMetaMethod &signal)
+{
+    if (signal == QMetaMethod::fromSignal(&SessionAuthorizer::requestAuthorizationForSession)) {
+        std::lock_guard<std::mutex> lock(m_listenerMutex);
+        m_listenerReady = true;
+        m_listenerConnected.notify_all();
+    }
+}
+
 bool SessionAuthorizer::configure_display_is_allowed(miral::ApplicationCredentials const& creds)
 {
     qCDebug(QTMIR_MIR_MESSAGES) << "SessionAuthorizer::configure_display_is_allowed - this=" << this << "pid=" << creds.pid();
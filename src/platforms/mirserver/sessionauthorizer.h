@@ -18,6 +18,10 @@
 #define SESSIONAUTHORIZER_H
 
 //std
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 
 // mir
@@ -44,8 +48,14 @@ Q_SIGNALS:
     // needs to be blocked queued signal which returns value for authorized
     void requestAuthorizationForSession(const pid_t &pid, bool &authorized);
 
+protected:
+    void connectNotify(const QMetaMethod &signal) override;
+
 private:
-    bool m_connectionChecked;
+    // Closed until the ApplicationManager listens to requestAuthorizationForSession, or we gave up waiting for it
+    std::atomic<bool> m_listenerReady;
+    std::mutex m_listenerMutex;
+    std::condition_variable m_listenerConnected;
 };
 
 #endif // SESSIONAUTHORIZER_H
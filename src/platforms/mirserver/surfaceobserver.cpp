@@ -16,43 +16,90 @@
 
 #include "surfaceobserver.h"
 
-#include <QHash>
-#include <QMutexLocker>
-#include <QMutex>
-
 #include <miral/window_specification.h>
 #include <mir/geometry/size.h>
 
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
 
 namespace {
 
-QRect calculateBoundingRect(const std::vector<mir::geometry::Rectangle> &rectVector)
+QVector<QRect> toQRects(const std::vector<mir::geometry::Rectangle> &rectVector)
 {
-    QRect boundingRect;
+    QVector<QRect> rects;
+    rects.reserve(rectVector.size());
     for (auto mirRect : rectVector) {
-        boundingRect |= QRect(mirRect.top_left.x.as_int(),
+        rects.append(QRect(mirRect.top_left.x.as_int(),
                 mirRect.top_left.y.as_int(),
                 mirRect.size.width.as_int(),
-                mirRect.size.height.as_int());
+                mirRect.size.height.as_int()));
     }
-    return boundingRect;
+    return rects;
 }
 
-QHash<const mir::scene::Surface*, SurfaceObserver*> surfaceToObserverMap;
-QMutex mutex;
+/*
+  Observers are registered from the Qt GUI thread and looked up from Mir threads, for every surface modification.
+  The registry is split in shards, each with its own lock held only for a hash table operation, so that
+  concurrent lookups and registrations of different surfaces seldom wait for each other. It holds weak
+  references only: the observer is owned by its MirSurface and by the Mir surface it observes.
+ */
+class ObserverRegistry
+{
+public:
+    void add(const mir::scene::Surface *surface, const std::shared_ptr<SurfaceObserver> &observer)
+    {
+        Shard &shard = shardFor(surface);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.observers[surface] = observer;
+    }
+
+    // Called by the destructor of the observer, at which point its weak references have all expired
+    void removeExpired(const mir::scene::Surface *surface)
+    {
+        Shard &shard = shardFor(surface);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.observers.find(surface);
+        if (it != shard.observers.end() && it->second.expired()) {
+            shard.observers.erase(it); // unless another observer was registered for it since
+        }
+    }
+
+    std::shared_ptr<SurfaceObserver> find(const mir::scene::Surface *surface)
+    {
+        Shard &shard = shardFor(surface);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.observers.find(surface);
+        return it != shard.observers.end() ? it->second.lock() : nullptr;
+    }
+
+private:
+    static const int ShardCount = 16;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<const mir::scene::Surface*, std::weak_ptr<SurfaceObserver>> observers;
+    };
+
+    Shard &shardFor(const mir::scene::Surface *surface)
+    {
+        // surfaces are heap allocated, the lowest bits of their address carry no information
+        return m_shards[(reinterpret_cast<std::uintptr_t>(surface) >> 6) % ShardCount];
+    }
+
+    std::array<Shard, ShardCount> m_shards;
+};
+
+ObserverRegistry registry;
 } // anonymous namespace
 
 
 SurfaceObserver::~SurfaceObserver()
 {
-    QMutexLocker locker(&mutex);
-    QMutableHashIterator<const mir::scene::Surface*, SurfaceObserver*> i(surfaceToObserverMap);
-    while (i.hasNext()) {
-        i.next();
-        if (i.value() == this) {
-            i.remove();
-            return;
-        }
+    if (m_registeredSurface) {
+        registry.removeExpired(m_registeredSurface);
     }
 }
 
@@ -80,8 +127,7 @@ void SurfaceObserver::notifySurfaceModifications(const miral::WindowSpecificatio
         Q_EMIT shellChromeChanged(modifications.shell_chrome().value());
     }
     if (modifications.input_shape().is_set()) {
-        QRect qRect = calculateBoundingRect(modifications.input_shape().value());
-        Q_EMIT inputBoundsChanged(qRect);
+        Q_EMIT inputShapeChanged(toQRects(modifications.input_shape().value()));
     }
     if (modifications.confine_pointer().is_set()) {
         Q_EMIT confinesMousePointerChanged(modifications.confine_pointer().value() == mir_pointer_confined_to_window);
@@ -91,17 +137,14 @@ void SurfaceObserver::notifySurfaceModifications(const miral::WindowSpecificatio
     }
 }
 
-SurfaceObserver *SurfaceObserver::observerForSurface(const mir::scene::Surface *surface)
+std::shared_ptr<SurfaceObserver> SurfaceObserver::observerForSurface(const mir::scene::Surface *surface)
 {
-    if (surfaceToObserverMap.contains(surface)) {
-        return surfaceToObserverMap.value(surface);
-    } else {
-        return nullptr;
-    }
+    return registry.find(surface);
 }
 
-void SurfaceObserver::registerObserverForSurface(SurfaceObserver *observer, const mir::scene::Surface *surface)
+void SurfaceObserver::registerObserverForSurface(const std::shared_ptr<SurfaceObserver> &observer,
+                                                 const mir::scene::Surface *surface)
 {
-    QMutexLocker locker(&mutex);
-    surfaceToObserverMap[surface] = observer;
+    observer->m_registeredSurface = surface;
+    registry.add(surface, observer);
 }
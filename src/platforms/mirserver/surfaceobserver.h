@@ -20,10 +20,13 @@
 #include <QObject>
 #include <QRect>
 #include <QSize>
+#include <QVector>
 
 #include <mir_toolkit/common.h>
 #include <mir/geometry/size.h>
 
+#include <memory>
+
 namespace mir {
     namespace scene {
         class Surface;
@@ -43,8 +46,10 @@ public:
 
     void notifySurfaceModifications(const miral::WindowSpecification&);
 
-    static SurfaceObserver *observerForSurface(const mir::scene::Surface *surface);
-    static void registerObserverForSurface(SurfaceObserver *observer, const mir::scene::Surface *surface);
+    // Thread-safe. The returned observer stays alive as long as the caller holds on to it.
+    static std::shared_ptr<SurfaceObserver> observerForSurface(const mir::scene::Surface *surface);
+    static void registerObserverForSurface(const std::shared_ptr<SurfaceObserver> &observer,
+                                           const mir::scene::Surface *surface);
 
 Q_SIGNALS:
     void attributeChanged(const MirWindowAttrib attribute, const int value);
@@ -60,8 +65,11 @@ Q_SIGNALS:
     void widthIncrementChanged(int);
     void heightIncrementChanged(int);
     void shellChromeChanged(MirShellChrome);
-    void inputBoundsChanged(const QRect &rect);
+    void inputShapeChanged(const QVector<QRect> &rects); // empty means the whole surface
     void confinesMousePointerChanged(bool);
+
+private:
+    const mir::scene::Surface *m_registeredSurface{nullptr}; // to unregister without searching
 };
 
 #endif
@@ -44,6 +44,7 @@ WindowManagementPolicy::WindowManagementPolicy(const miral::WindowManagerTools &
     , m_appNotifier(appNotifier)
 {
     qRegisterMetaType<qtmir::NewWindow>();
+    qRegisterMetaType<qtmir::WindowModelChanges>();
     qRegisterMetaType<std::vector<miral::Window>>();
     qRegisterMetaType<miral::ApplicationInfo>();
     windowController.setPolicy(this);
@@ -76,6 +77,7 @@ void WindowManagementPolicy::handle_window_ready(miral::WindowInfo &windowInfo)
 {
     CanonicalWindowManagerPolicy::handle_window_ready(windowInfo);
 
+    flushWindowChanges();
     Q_EMIT m_windowModel.windowReady(windowInfo);
 
     auto appInfo = tools.info_for(windowInfo.window().application());
@@ -100,13 +102,14 @@ void WindowManagementPolicy::handle_modify_window(
 
     // TODO Once Qt processes the request we probably don't want to notify from here
     std::shared_ptr<mir::scene::Surface> surface{windowInfo.window()};
-    if (SurfaceObserver *observer = SurfaceObserver::observerForSurface(surface.get())) {
+    if (auto observer = SurfaceObserver::observerForSurface(surface.get())) {
         observer->notifySurfaceModifications(modifications);
     }
 }
 
 void WindowManagementPolicy::handle_raise_window(miral::WindowInfo &windowInfo)
 {
+    flushWindowChanges();
     Q_EMIT m_windowModel.windowRequestedRaise(windowInfo);
 }
 
@@ -138,17 +141,24 @@ void WindowManagementPolicy::advise_new_window(const miral::WindowInfo &windowIn
     // FIXME: remove when possible
     getExtraInfo(windowInfo)->state = toQtState(windowInfo.state());
 
+    flushWindowChanges();
     Q_EMIT m_windowModel.windowAdded(NewWindow{windowInfo});
 }
 
 void WindowManagementPolicy::advise_delete_window(const miral::WindowInfo &windowInfo)
 {
+    flushWindowChanges();
     Q_EMIT m_windowModel.windowRemoved(windowInfo);
 }
 
 void WindowManagementPolicy::advise_raise(const std::vector<miral::Window> &windows)
 {
-    Q_EMIT m_windowModel.windowsRaised(windows);
+    if (m_inTransaction) {
+        m_windowChanges.raise(windows);
+    } else {
+        flushWindowChanges();
+        Q_EMIT m_windowModel.windowsRaised(windows);
+    }
 }
 
 void WindowManagementPolicy::advise_new_app(miral::ApplicationInfo &application)
@@ -160,6 +170,8 @@ void WindowManagementPolicy::advise_new_app(miral::ApplicationInfo &application)
 void WindowManagementPolicy::advise_delete_app(const miral::ApplicationInfo &application)
 {
     tracepoint(qtmirserver, stopping);
+    // Also covers applications that died before the shell got to remove their session
+    InitialSurfaceSizes::remove(miral::pid_of(application.application()));
     Q_EMIT m_appNotifier.appRemoved(application);
 }
 
@@ -176,62 +188,100 @@ void WindowManagementPolicy::advise_state_change(const miral::WindowInfo &window
         extraWinInfo->state = toQtState(state);
     }
 
-    Q_EMIT m_windowModel.windowStateChanged(windowInfo, extraWinInfo->state);
+    if (m_inTransaction) {
+        m_windowChanges.stateChanged[windowInfo.window()] = extraWinInfo->state;
+    } else {
+        flushWindowChanges();
+        Q_EMIT m_windowModel.windowStateChanged(windowInfo, extraWinInfo->state);
+    }
 }
 
 void WindowManagementPolicy::advise_move_to(const miral::WindowInfo &windowInfo, Point topLeft)
 {
-    Q_EMIT m_windowModel.windowMoved(windowInfo, toQPoint(topLeft));
+    // interactive moves can outpace the Qt side, only the latest position matters
+    m_windowModel.postWindowMoved(windowInfo.window(), toQPoint(topLeft));
 }
 
 void WindowManagementPolicy::advise_resize(const miral::WindowInfo &windowInfo, const Size &newSize)
 {
-    Q_EMIT m_windowModel.windowResized(windowInfo, toQSize(newSize));
+    m_windowModel.postWindowResized(windowInfo, toQSize(newSize));
 }
 
 void WindowManagementPolicy::advise_focus_lost(const miral::WindowInfo &windowInfo)
 {
-    Q_EMIT m_windowModel.windowFocusChanged(windowInfo, false);
+    m_activeWindow.focusLost(windowInfo.window());
+
+    if (m_inTransaction) {
+        m_windowChanges.focusChanged[windowInfo.window()] = false;
+    } else {
+        flushWindowChanges();
+        Q_EMIT m_windowModel.windowFocusChanged(windowInfo, false);
+    }
 }
 
 void WindowManagementPolicy::advise_focus_gained(const miral::WindowInfo &windowInfo)
 {
-    // update Qt model ASAP, before applying Mir policy
-    Q_EMIT m_windowModel.windowFocusChanged(windowInfo, true);
+    m_activeWindow.focusGained(windowInfo.window());
+
+    // Outside of a transaction, update Qt model ASAP, before applying Mir policy. Within one, the change is posted
+    // along with the others at advise_end.
+    if (m_inTransaction) {
+        m_windowChanges.focusChanged[windowInfo.window()] = true;
+    } else {
+        flushWindowChanges();
+        Q_EMIT m_windowModel.windowFocusChanged(windowInfo, true);
+    }
 
     CanonicalWindowManagerPolicy::advise_focus_gained(windowInfo);
 }
 
+// Every locked window manager operation is a transaction, down to each pointer motion of an interactive move.
+// Those only post geometry, which must not be flushed here or moves would no longer be coalesced.
 void WindowManagementPolicy::advise_begin()
 {
+    m_inTransaction = true;
     Q_EMIT m_windowModel.modificationsStarted();
 }
 
 void WindowManagementPolicy::advise_end()
 {
+    if (!m_windowChanges.isEmpty()) {
+        flushWindowChanges();
+    }
+    m_inTransaction = false;
     Q_EMIT m_windowModel.modificationsEnded();
 }
 
+// Posts the pending window moves and resizes, then the changes accumulated so far in this transaction as a
+// single event. Done before any other window model signal too, so that the Qt side sees all events in the order
+// Mir made them.
+void WindowManagementPolicy::flushWindowChanges()
+{
+    m_windowModel.flushGeometryChanges();
+
+    if (m_windowChanges.isEmpty()) {
+        return;
+    }
+    Q_EMIT m_windowModel.windowsChanged(m_windowChanges);
+    m_windowChanges = WindowModelChanges();
+}
+
 void WindowManagementPolicy::ensureWindowIsActive(const miral::Window &window)
 {
-    tools.invoke_under_lock([&window, this]() {
-        if (tools.active_window() != window) {
-            tools.select_active_window(window);
-        }
+    // Called for every key press and touch, only take the window manager lock if focus needs to change
+    m_activeWindow.ensureActive(window, [&window, this]() {
+        tools.invoke_under_lock([&window, this]() {
+            if (tools.active_window() != window) {
+                tools.select_active_window(window);
+            }
+        });
     });
 }
 
 QRect WindowManagementPolicy::getConfinementRect(const QRect rect) const
 {
-    QRect confinementRect;
-    for (const QRect r : m_confinementRegions) {
-        if (r.intersects(rect)) {
-            confinementRect = r;
-            // TODO: What if there are multiple confinement regions and they intersect??
-            break;
-        }
-    }
-    return confinementRect;
+    // Where regions overlap, the window is confined to the one it is mostly in
+    return m_confinementRegions.largestOverlapWith(rect);
 }
 
 /* Following methods all called from the Qt GUI thread to deliver events to clients */
@@ -339,7 +389,7 @@ void WindowManagementPolicy::forceClose(const miral::Window &window)
 
 void WindowManagementPolicy::set_window_confinement_regions(const QVector<QRect> &regions)
 {
-    m_confinementRegions = regions;
+    m_confinementRegions = qtmir::RectRegion(regions);
 
     // TODO: update window positions to respect new boundary.
 }
@@ -368,6 +418,8 @@ void WindowManagementPolicy::requestState(const miral::Window &window, const Mir
     extraWinInfo->state = state;
 
     if (modifications.state() == windowInfo.state()) {
+        // Called from the Qt side, not under the window manager lock: leave the transaction changes alone
+        m_windowModel.flushGeometryChanges();
         Q_EMIT m_windowModel.windowStateChanged(windowInfo, state);
     } else {
         tools.invoke_under_lock([&]() {
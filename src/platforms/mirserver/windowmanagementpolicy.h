@@ -19,8 +19,10 @@
 
 #include "miral/canonical_window_manager.h"
 
+#include "activewindowtracker.h"
 #include "appnotifier.h"
 #include "qteventfeeder.h"
+#include "rectregion.h"
 #include "windowcontroller.h"
 #include "windowmodelnotifier.h"
 
@@ -89,11 +91,16 @@ public:
 private:
     void ensureWindowIsActive(const miral::Window &window);
     QRect getConfinementRect(const QRect rect) const;
+    void flushWindowChanges();
 
     qtmir::WindowModelNotifier &m_windowModel;
+    // Only touched with the window manager lock held
+    bool m_inTransaction{false};
+    qtmir::WindowModelChanges m_windowChanges;
+    qtmir::ActiveWindowTracker m_activeWindow;
     qtmir::AppNotifier &m_appNotifier;
     QtEventFeeder m_eventFeeder;
-    QVector<QRect> m_confinementRegions;
+    qtmir::RectRegion m_confinementRegions;
     QMargins m_windowMargins[mir_window_types];
 };
 
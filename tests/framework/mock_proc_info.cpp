@@ -24,16 +24,19 @@ MockProcInfo::MockProcInfo()
     using namespace ::testing;
     ON_CALL(*this, command_line(_)).WillByDefault(Return(QByteArray()));
     ON_CALL(*this, set_environment(_)).WillByDefault(Return(QByteArray()));
+    ON_CALL(*this, residentMemory(_)).WillByDefault(Return(0));
+    ON_CALL(*this, startTime(_)).WillByDefault(Return(0));
 }
 
+// Tests give space separated lists for convenience, /proc uses NUL separators
 std::unique_ptr<qtmir::ProcInfo::CommandLine> MockProcInfo::commandLine(pid_t pid)
 {
-    return std::unique_ptr<CommandLine>(new CommandLine{command_line(pid)});
+    return std::unique_ptr<CommandLine>(new CommandLine{command_line(pid).replace(' ', '\0')});
 }
 
 std::unique_ptr<qtmir::ProcInfo::Environment> MockProcInfo::environment(pid_t pid)
 {
-    return std::unique_ptr<Environment>(new Environment{set_environment(pid)});
+    return std::unique_ptr<Environment>(new Environment{set_environment(pid).replace(' ', '\0')});
 }
 
 } // namespace qtmir
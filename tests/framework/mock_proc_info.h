@@ -30,6 +30,8 @@ struct MockProcInfo : public qtmir::ProcInfo
 
     MOCK_METHOD1(command_line, QByteArray(pid_t));
     MOCK_METHOD1(set_environment, QByteArray(pid_t));
+    MOCK_METHOD1(residentMemory, qint64(pid_t));
+    MOCK_METHOD1(startTime, quint64(pid_t));
 
     std::unique_ptr<CommandLine> commandLine(pid_t pid) override;
     std::unique_ptr<Environment> environment(pid_t pid) override;
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <activewindowtracker.h>
+
+#include <miral/application.h>
+#include <mir/test/doubles/stub_session.h>
+#include <mir/test/doubles/stub_surface.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace qtmir;
+using StubSession = mir::test::doubles::StubSession;
+using StubSurface = mir::test::doubles::StubSurface;
+
+class ActiveWindowTrackerTest : public ::testing::Test
+{
+public:
+    const std::shared_ptr<StubSession> stubSession{std::make_shared<StubSession>()};
+    const std::shared_ptr<StubSurface> stubSurface{std::make_shared<StubSurface>()};
+    const miral::Window window1{stubSession, stubSurface};
+    const miral::Window window2{stubSession, stubSurface};
+};
+
+TEST_F(ActiveWindowTrackerTest, FollowsFocusChanges)
+{
+    ActiveWindowTracker tracker;
+    EXPECT_FALSE(tracker.isActive(window1));
+
+    tracker.focusGained(window1);
+    EXPECT_TRUE(tracker.isActive(window1));
+    EXPECT_FALSE(tracker.isActive(window2));
+
+    // focus moving from a window to another may be advised in either order
+    tracker.focusGained(window2);
+    tracker.focusLost(window1);
+    EXPECT_TRUE(tracker.isActive(window2));
+
+    tracker.focusLost(window2);
+    EXPECT_FALSE(tracker.isActive(window2));
+}
+
+TEST_F(ActiveWindowTrackerTest, ActivatesOnlyWhenFocusMustChange)
+{
+    ActiveWindowTracker tracker;
+    int activations = 0;
+    auto activate = [&](const miral::Window &window) {
+        return [&tracker, &activations, window]() {
+            ++activations;
+            tracker.focusGained(window); // what Mir advises in response
+        };
+    };
+
+    tracker.ensureActive(window1, activate(window1));
+    tracker.ensureActive(window1, activate(window1));
+    tracker.ensureActive(window1, activate(window1));
+    EXPECT_EQ(1, activations);
+
+    tracker.ensureActive(window2, activate(window2));
+    tracker.ensureActive(window2, activate(window2));
+    EXPECT_EQ(2, activations);
+
+    EXPECT_EQ(3u, tracker.activationsSkipped());
+    EXPECT_EQ(2u, tracker.activationsAttempted());
+}
+
+/*
+ * Touch events delivered on the Qt side to the active window must not wait for the window manager lock, which
+ * the Mir side keeps busy with window operations
+ */
+TEST_F(ActiveWindowTrackerTest, TouchesOnTheActiveWindowLeaveTheWindowManagerLockAlone)
+{
+    const int touchCount = 2000;
+
+    std::mutex windowManagerLock;
+    ActiveWindowTracker tracker;
+    tracker.focusGained(window1);
+
+    std::atomic<int> locksTaken{0};
+    auto activate = [&]() {
+        std::lock_guard<std::mutex> lock(windowManagerLock);
+        ++locksTaken;
+        tracker.focusGained(window1);
+    };
+
+    std::atomic<bool> done{false};
+    std::thread mirThread([&]() {
+        while (!done) {
+            std::lock_guard<std::mutex> lock(windowManagerLock);
+            std::this_thread::yield(); // moving, resizing...
+        }
+    });
+
+    for (int i = 0; i < touchCount; ++i) {
+        tracker.ensureActive(window1, activate);
+    }
+
+    done = true;
+    mirThread.join();
+
+    EXPECT_EQ(0, locksTaken);
+    EXPECT_EQ(static_cast<quint64>(touchCount), tracker.activationsSkipped());
+    EXPECT_EQ(0u, tracker.activationsAttempted());
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <initialsurfacesizes.h>
+#include <procstat.h>
+
+#include <atomic>
+#include <thread>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+class InitialSurfaceSizesTest : public ::testing::Test
+{
+public:
+    ~InitialSurfaceSizesTest()
+    {
+        InitialSurfaceSizes::remove(getpid());
+    }
+};
+
+TEST_F(InitialSurfaceSizesTest, SizeIsKeptUntilRemoved)
+{
+    InitialSurfaceSizes::set(getpid(), QSize(100, 200));
+    EXPECT_EQ(QSize(100, 200), InitialSurfaceSizes::get(getpid()));
+
+    InitialSurfaceSizes::remove(getpid());
+    EXPECT_FALSE(InitialSurfaceSizes::get(getpid()).isValid());
+}
+
+TEST_F(InitialSurfaceSizesTest, SizeOfAProcessThatIsGoneIsNotUsed)
+{
+    const pid_t child = fork();
+    ASSERT_NE(-1, child);
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+
+    EXPECT_NE(0u, qtmir::processStartTime(child));
+    InitialSurfaceSizes::set(child, QSize(100, 200));
+    EXPECT_EQ(QSize(100, 200), InitialSurfaceSizes::get(child));
+
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+
+    // A new process with that pid must not get it
+    EXPECT_FALSE(InitialSurfaceSizes::get(child).isValid());
+
+    InitialSurfaceSizes::remove(child);
+}
+
+TEST_F(InitialSurfaceSizesTest, OldestSizesAreDroppedBeyondTheBound)
+{
+    // pids above the kernel's pid_max, nobody can have them
+    const pid_t firstPid = 1 << 23;
+    const int count = 3 * InitialSurfaceSizes::MaxEntries;
+
+    for (int i = 0; i < count; ++i) {
+        InitialSurfaceSizes::set(firstPid + i, QSize(i + 1, i + 1));
+    }
+    EXPECT_EQ(InitialSurfaceSizes::MaxEntries, InitialSurfaceSizes::count());
+
+    InitialSurfaceSizes::set(getpid(), QSize(100, 200));
+    EXPECT_EQ(InitialSurfaceSizes::MaxEntries, InitialSurfaceSizes::count());
+    EXPECT_EQ(QSize(100, 200), InitialSurfaceSizes::get(getpid()));
+
+    for (int i = 0; i < count; ++i) {
+        InitialSurfaceSizes::remove(firstPid + i);
+    }
+    EXPECT_EQ(1, InitialSurfaceSizes::count());
+}
+
+TEST_F(InitialSurfaceSizesTest, ReadersSeeEitherSizeWhileItIsReplaced)
+{
+    std::atomic<bool> done{false};
+    std::atomic<int> unexpected{0};
+
+    InitialSurfaceSizes::set(getpid(), QSize(1, 1));
+
+    std::thread reader([&] {
+        while (!done) {
+            const QSize size = InitialSurfaceSizes::get(getpid());
+            if (size != QSize(1, 1) && size != QSize(2, 2)) {
+                ++unexpected;
+            }
+        }
+    });
+
+    for (int i = 0; i < 10000; ++i) {
+        InitialSurfaceSizes::set(getpid(), i % 2 ? QSize(1, 1) : QSize(2, 2));
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(0, unexpected);
+}
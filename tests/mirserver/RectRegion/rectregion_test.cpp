@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <rectregion.h>
+
+#include <random>
+
+using namespace qtmir;
+
+namespace {
+QVector<QRect> randomRects(std::mt19937 &random, int count, int extent, int maxSize)
+{
+    std::uniform_int_distribution<int> position(-extent / 10, extent);
+    std::uniform_int_distribution<int> size(0, maxSize); // some empty ones too
+    QVector<QRect> rects;
+    for (int i = 0; i < count; ++i) {
+        rects.append(QRect(position(random), position(random), size(random), size(random)));
+    }
+    return rects;
+}
+}
+
+TEST(RectRegionTest, EmptyRegionContainsNothing)
+{
+    RectRegion region;
+
+    EXPECT_TRUE(region.isEmpty());
+    EXPECT_FALSE(region.contains(QPoint(0, 0)));
+    EXPECT_TRUE(region.intersecting(QRect(0, 0, 10, 10)).isEmpty());
+    EXPECT_TRUE(region.largestOverlapWith(QRect(0, 0, 10, 10)).isNull());
+
+    EXPECT_TRUE(RectRegion({QRect(5, 5, 0, 10)}).isEmpty());
+}
+
+TEST(RectRegionTest, EdgesAreInclusiveLikeQRect)
+{
+    RectRegion region({QRect(10, 10, 10, 10), QRect(20, 10, 5, 5)});
+
+    EXPECT_TRUE(region.contains(QPoint(10, 10)));
+    EXPECT_TRUE(region.contains(QPoint(19, 19)));
+    EXPECT_TRUE(region.contains(QPoint(24, 14))); // adjacent rectangles join
+    EXPECT_FALSE(region.contains(QPoint(24, 15)));
+    EXPECT_FALSE(region.contains(QPoint(20, 19)));
+    EXPECT_FALSE(region.contains(QPoint(9, 10)));
+    EXPECT_FALSE(region.contains(QPoint(10, 20)));
+    EXPECT_EQ(QRect(10, 10, 15, 10), region.boundingRect());
+}
+
+TEST(RectRegionTest, OverlappingConfinementRegionsPickTheOneMostOverlapped)
+{
+    // two monitors, the second one overlapping the first one, like a mirrored area
+    RectRegion region({QRect(0, 0, 1920, 1080), QRect(1800, 0, 1280, 1024)});
+
+    EXPECT_EQ(QRect(0, 0, 1920, 1080), region.largestOverlapWith(QRect(1700, 100, 200, 200)));
+    EXPECT_EQ(QRect(1800, 0, 1280, 1024), region.largestOverlapWith(QRect(1850, 100, 200, 200)));
+    EXPECT_EQ(QRect(0, 0, 1920, 1080), region.largestOverlapWith(QRect(100, 1000, 50, 500))); // below the second
+    EXPECT_TRUE(region.largestOverlapWith(QRect(4000, 0, 10, 10)).isNull());
+}
+
+TEST(RectRegionTest, RandomRegionsMatchBruteForce)
+{
+    std::mt19937 random(7); // fixed seed, failures must be reproducible
+    std::uniform_int_distribution<int> coordinate(-20, 220);
+
+    for (int count = 1; count <= 30; ++count) {
+        const QVector<QRect> rects = randomRects(random, count, 200, 80);
+        const RectRegion region(rects);
+
+        QVector<QRect> nonEmpty;
+        for (const QRect &rect : rects) {
+            if (!rect.isEmpty()) {
+                nonEmpty.append(rect);
+            }
+        }
+        ASSERT_EQ(nonEmpty, region.rects());
+
+        for (int i = 0; i < 200; ++i) {
+            const QPoint point(coordinate(random), coordinate(random));
+            bool contained = false;
+            for (const QRect &rect : nonEmpty) {
+                contained |= rect.contains(point);
+            }
+            ASSERT_EQ(contained, region.contains(point)) << "point " << point.x() << "," << point.y();
+
+            const QRect query = randomRects(random, 1, 200, 60).first();
+            QVector<int> intersecting;
+            for (int j = 0; j < nonEmpty.count(); ++j) {
+                if (nonEmpty[j].intersects(query)) {
+                    intersecting.append(j);
+                }
+            }
+            ASSERT_EQ(intersecting, region.intersecting(query));
+        }
+    }
+}
+
+TEST(RectRegionTest, HitTestingAmongManyRectanglesMatchesBruteForce)
+{
+    const int rectCount = 1000;
+    const int queryCount = 10000;
+
+    std::mt19937 random(3);
+    const QVector<QRect> rects = randomRects(random, rectCount, 4000, 100);
+    const RectRegion region(rects);
+
+    std::uniform_int_distribution<int> coordinate(0, 4000);
+    int hits = 0;
+    for (int i = 0; i < queryCount; ++i) {
+        const QPoint point(coordinate(random), coordinate(random));
+        bool contained = false;
+        for (const QRect &rect : rects) {
+            if (rect.contains(point)) {
+                contained = true;
+                break;
+            }
+        }
+        ASSERT_EQ(contained, region.contains(point)) << "point " << point.x() << "," << point.y();
+        hits += contained;
+    }
+
+    // Neither everything nor nothing, or the test would not tell much
+    EXPECT_GT(hits, 0);
+    EXPECT_LT(hits, queryCount);
+}
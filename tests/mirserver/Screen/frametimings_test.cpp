@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <frametimings.h>
+
+#include <thread>
+
+using namespace qtmir;
+
+namespace {
+FrameTiming timingWithRender(int64_t render)
+{
+    FrameTiming timing;
+    timing.render = render;
+    return timing;
+}
+}
+
+TEST(FrameTimingRingTest, EmptyRingHasNoSnapshot)
+{
+    FrameTimingRing ring;
+
+    EXPECT_EQ(0u, ring.frameCount());
+    EXPECT_TRUE(ring.snapshot().isEmpty());
+}
+
+TEST(FrameTimingRingTest, SnapshotIsOldestFirst)
+{
+    FrameTimingRing ring;
+
+    for (int i = 0; i < 3; ++i) {
+        ring.push(timingWithRender(i * 10));
+    }
+
+    auto timings = ring.snapshot();
+    ASSERT_EQ(3, timings.count());
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(static_cast<uint64_t>(i), timings[i].frameNumber);
+        EXPECT_EQ(i * 10, timings[i].render);
+    }
+}
+
+TEST(FrameTimingRingTest, KeepsOnlyTheMostRecentFrames)
+{
+    FrameTimingRing ring;
+    const int total = FrameTimingRing::Capacity * 2 + 5;
+
+    for (int i = 0; i < total; ++i) {
+        ring.push(timingWithRender(i));
+    }
+
+    auto timings = ring.snapshot();
+    ASSERT_EQ(FrameTimingRing::Capacity, timings.count());
+    EXPECT_EQ(static_cast<uint64_t>(total - FrameTimingRing::Capacity), timings.first().frameNumber);
+    EXPECT_EQ(static_cast<uint64_t>(total - 1), timings.last().frameNumber);
+
+    timings = ring.snapshot(4);
+    ASSERT_EQ(4, timings.count());
+    EXPECT_EQ(total - 4, timings.first().render);
+}
+
+TEST(FrameTimingRingTest, ConcurrentReaderOnlySeesConsistentFrames)
+{
+    FrameTimingRing ring;
+    const int total = 100000;
+
+    std::thread writer([&ring]() {
+        for (int i = 0; i < total; ++i) {
+            FrameTiming timing;
+            timing.render = i;
+            timing.swap = i;
+            timing.post = i;
+            ring.push(timing);
+        }
+    });
+
+    while (ring.frameCount() < static_cast<uint64_t>(total)) {
+        for (const auto &timing : ring.snapshot()) {
+            ASSERT_EQ(static_cast<int64_t>(timing.frameNumber), timing.render);
+            ASSERT_EQ(timing.render, timing.swap);
+            ASSERT_EQ(timing.render, timing.post);
+        }
+    }
+
+    writer.join();
+}
@@ -22,7 +22,11 @@
 
 #include <screen.h>
 
+#include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QSensorManager>
+#include <QThread>
+#include <qpa/qwindowsysteminterface.h>
 
 using namespace ::testing;
 
@@ -32,6 +36,31 @@ namespace geom = mir::geometry;
 class ScreenTest : public ::testing::Test {
 protected:
     void SetUp() override;
+
+    // As if from the sensor thread
+    void feedReading(Screen *screen, QOrientationReading::Orientation reading)
+    {
+        screen->onOrientationReading(reading);
+    }
+
+    // As if from the render thread, a frame started at frameStart and posted frameDuration later
+    void postFrame(Screen *screen, std::chrono::steady_clock::time_point frameStart, std::chrono::milliseconds frameDuration)
+    {
+        const auto postEnd = frameStart + frameDuration;
+        screen->m_frameStartTime = frameStart;
+        screen->m_renderStartTime = frameStart;
+        screen->recordFrameTiming(postEnd, postEnd, postEnd);
+    }
+
+    void processEventsFor(int msecs)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        do {
+            QCoreApplication::processEvents();
+            QThread::msleep(1);
+        } while (timer.elapsed() < msecs);
+    }
 };
 
 void ScreenTest::SetUp()
@@ -78,6 +107,85 @@ TEST_F(ScreenTest, OrientationSensorForInternalDisplay)
     ASSERT_TRUE(screen->orientationSensorEnabled());
 }
 
+TEST_F(ScreenTest, OrientationHysteresisIsConfigurable)
+{
+    Screen *screen = new Screen(fakeOutput2);
+
+    screen->setOrientationHysteresis(50);
+    EXPECT_EQ(screen->orientationHysteresis(), 50);
+
+    screen->setOrientationHysteresis(-1);
+    EXPECT_EQ(screen->orientationHysteresis(), 0);
+}
+
+TEST_F(ScreenTest, NegativeOrientationHysteresisFromTheEnvironmentIsClamped)
+{
+    qputenv("QTMIR_ORIENTATION_HYSTERESIS_MS", "-100");
+    Screen *screen = new Screen(fakeOutput2);
+    qunsetenv("QTMIR_ORIENTATION_HYSTERESIS_MS");
+
+    EXPECT_EQ(screen->orientationHysteresis(), 0);
+}
+
+TEST_F(ScreenTest, ReadingsPersistingForTheHysteresisAreApplied)
+{
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv); // for the settle timer
+
+    QScopedPointer<Screen> screen(new Screen(fakeOutput2)); // is internal display, portrait
+    screen->setOrientationHysteresis(50);
+    const int queuedBefore = QWindowSystemInterface::windowSystemEventsQueued();
+
+    feedReading(screen.data(), QOrientationReading::LeftUp);
+    processEventsFor(200);
+    EXPECT_EQ(Qt::LandscapeOrientation, screen->orientation());
+    EXPECT_EQ(queuedBefore + 1, QWindowSystemInterface::windowSystemEventsQueued());
+}
+
+TEST_F(ScreenTest, ShortLivedReadingsAreFilteredOut)
+{
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv); // for the settle timer
+
+    QScopedPointer<Screen> screen(new Screen(fakeOutput2)); // is internal display, portrait
+    screen->setOrientationHysteresis(500);
+    const int queuedBefore = QWindowSystemInterface::windowSystemEventsQueued();
+
+    // Tilted sideways for a moment, back upright well within the hysteresis
+    feedReading(screen.data(), QOrientationReading::LeftUp);
+    processEventsFor(10);
+    feedReading(screen.data(), QOrientationReading::TopUp);
+
+    processEventsFor(1000);
+    EXPECT_EQ(Qt::PortraitOrientation, screen->orientation());
+    EXPECT_EQ(queuedBefore, QWindowSystemInterface::windowSystemEventsQueued());
+}
+
+TEST_F(ScreenTest, UnchangedOrientationIsNotReported)
+{
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv);
+
+    QScopedPointer<Screen> screen(new Screen(fakeOutput2)); // is internal display, portrait
+    screen->setOrientationHysteresis(0);
+    const int queuedBefore = QWindowSystemInterface::windowSystemEventsQueued();
+
+    feedReading(screen.data(), QOrientationReading::TopUp); // the current orientation
+    feedReading(screen.data(), QOrientationReading::FaceUp); // lying flat, no orientation
+    qtApp.processEvents();
+    EXPECT_EQ(Qt::PortraitOrientation, screen->orientation());
+    EXPECT_EQ(queuedBefore, QWindowSystemInterface::windowSystemEventsQueued());
+
+    feedReading(screen.data(), QOrientationReading::LeftUp);
+    feedReading(screen.data(), QOrientationReading::LeftUp);
+    qtApp.processEvents();
+    EXPECT_EQ(Qt::LandscapeOrientation, screen->orientation());
+    EXPECT_EQ(queuedBefore + 1, QWindowSystemInterface::windowSystemEventsQueued());
+}
+
 TEST_F(ScreenTest, ReadConfigurationFromDisplayConfig)
 {
     Screen *screen = new Screen(fakeOutput1);
@@ -103,3 +211,37 @@ TEST_F(ScreenTest, ReadDifferentConfigurationFromDisplayConfig)
     EXPECT_EQ(screen->physicalSize(), QSize(1000, 2000));
     EXPECT_EQ(screen->outputType(), qtmir::OutputTypes::LVDS);
 }
+
+TEST_F(ScreenTest, NoFrameTimingsBeforeRendering)
+{
+    Screen *screen = new Screen(fakeOutput1);
+
+    EXPECT_TRUE(screen->frameTimings().isEmpty());
+}
+
+TEST_F(ScreenTest, IdleTimeBetweenFramesIsNotAMissedVBlank)
+{
+    using namespace std::chrono;
+    Screen *screen = new Screen(fakeOutput2); // 90Hz, about 11ms per refresh
+
+    const auto start = steady_clock::now();
+    postFrame(screen, start, milliseconds(10));
+    postFrame(screen, start + seconds(1), milliseconds(10));
+
+    const auto timings = screen->frameTimings();
+    ASSERT_EQ(2, timings.count());
+    EXPECT_EQ(0, timings[0].missedVBlanks);
+    EXPECT_EQ(0, timings[1].missedVBlanks);
+}
+
+TEST_F(ScreenTest, SlowFrameMissesVBlanks)
+{
+    using namespace std::chrono;
+    Screen *screen = new Screen(fakeOutput2); // 90Hz, about 11ms per refresh
+
+    postFrame(screen, steady_clock::now(), milliseconds(40));
+
+    const auto timings = screen->frameTimings();
+    ASSERT_EQ(1, timings.count());
+    EXPECT_EQ(3, timings[0].missedVBlanks);
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+#include "gmock_fixes.h"
+
+#include "stub_display.h"
+#include "stub_displayconfigurationcontroller.h"
+#include "mock_gl_display_buffer.h"
+#include "qtcompositor.h"
+#include "fake_displayconfigurationoutput.h"
+
+#include "testable_screensmodel.h"
+#include "screen.h"
+#include "screenscontroller.h"
+
+#include <QGuiApplication>
+#include <QLoggingCategory>
+
+using namespace ::testing;
+
+namespace mg = mir::graphics;
+
+class ScreensControllerTest : public ::testing::Test {
+protected:
+    void SetUp() override;
+    void TearDown() override;
+
+    CustomScreenConfigurationList withScale(float scale) const;
+    CustomScreenConfigurationList withFormFactor(MirFormFactor formFactor) const;
+
+    QSharedPointer<ScreensModel> screensModel;
+    std::shared_ptr<StubDisplay> display;
+    std::shared_ptr<StubDisplayConfigurationController> displayConfigurationController;
+    ScreensController *controller;
+    QGuiApplication *app;
+};
+
+void ScreensControllerTest::SetUp()
+{
+    setenv("QT_QPA_PLATFORM", "minimal", 1);
+    Screen::skipDBusRegistration = true;
+
+    // We don't want the logging spam cluttering the test results
+    QLoggingCategory::setFilterRules(QStringLiteral("qtmir.*=false"));
+
+    int argc = 0;
+    char **argv = nullptr;
+    app = new QGuiApplication(argc, argv);
+
+    auto testableModel = new TestableScreensModel;
+    screensModel.reset(testableModel);
+    display = std::make_shared<StubDisplay>();
+    displayConfigurationController = std::make_shared<StubDisplayConfigurationController>();
+    testableModel->do_init(display, std::make_shared<QtCompositor>(), std::make_shared<StubDisplayListener>());
+
+    std::vector<mg::DisplayConfigurationOutput> config{fakeOutput1, fakeOutput2};
+    std::vector<MockGLDisplayBuffer*> bufferConfig; // only used to match buffer with display, unecessary here
+    display->setFakeConfiguration(config, bufferConfig);
+    screensModel->update();
+
+    controller = new ScreensController(screensModel, display, displayConfigurationController);
+}
+
+void ScreensControllerTest::TearDown()
+{
+    delete controller;
+    screensModel.reset();
+    delete app;
+}
+
+CustomScreenConfigurationList ScreensControllerTest::withScale(float scale) const
+{
+    auto configs = controller->configuration();
+    configs[0].scale = scale;
+    return configs;
+}
+
+CustomScreenConfigurationList ScreensControllerTest::withFormFactor(MirFormFactor formFactor) const
+{
+    auto configs = controller->configuration();
+    configs[0].formFactor = formFactor;
+    return configs;
+}
+
+TEST_F(ScreensControllerTest, EachChangeOutsideTransactionIsAppliedImmediately)
+{
+    ASSERT_TRUE(controller->setConfiguration(withScale(2.0)));
+    ASSERT_TRUE(controller->setConfiguration(withFormFactor(mir_form_factor_tv)));
+
+    EXPECT_EQ(2, displayConfigurationController->baseConfigurationChanges);
+}
+
+TEST_F(ScreensControllerTest, UnchangedConfigurationIsNotApplied)
+{
+    ASSERT_TRUE(controller->setConfiguration(controller->configuration()));
+
+    EXPECT_EQ(0, displayConfigurationController->baseConfigurationChanges);
+}
+
+TEST_F(ScreensControllerTest, TransactionAppliesAllChangesOnce)
+{
+    controller->beginConfiguration();
+
+    ASSERT_TRUE(controller->setConfiguration(withScale(2.0)));
+    ASSERT_TRUE(controller->setConfiguration(withFormFactor(mir_form_factor_tv)));
+    EXPECT_EQ(0, displayConfigurationController->baseConfigurationChanges);
+
+    // later changes in the transaction build upon the earlier ones
+    EXPECT_EQ(2.0f, controller->configuration()[0].scale);
+    EXPECT_EQ(mir_form_factor_tv, controller->configuration()[0].formFactor);
+
+    ASSERT_TRUE(controller->commitConfiguration());
+    EXPECT_EQ(1, displayConfigurationController->baseConfigurationChanges);
+    EXPECT_FALSE(controller->inTransaction());
+}
+
+TEST_F(ScreensControllerTest, NestedTransactionsApplyOnOutermostCommit)
+{
+    controller->beginConfiguration();
+    ASSERT_TRUE(controller->setConfiguration(withScale(2.0)));
+
+    controller->beginConfiguration();
+    ASSERT_TRUE(controller->setConfiguration(withFormFactor(mir_form_factor_tv)));
+    ASSERT_TRUE(controller->commitConfiguration());
+    EXPECT_EQ(0, displayConfigurationController->baseConfigurationChanges);
+
+    ASSERT_TRUE(controller->commitConfiguration());
+    EXPECT_EQ(1, displayConfigurationController->baseConfigurationChanges);
+}
+
+TEST_F(ScreensControllerTest, EmptyTransactionAppliesNothing)
+{
+    controller->beginConfiguration();
+    ASSERT_TRUE(controller->commitConfiguration());
+
+    EXPECT_EQ(0, displayConfigurationController->baseConfigurationChanges);
+}
+
+TEST_F(ScreensControllerTest, CommitWithoutTransactionFails)
+{
+    EXPECT_FALSE(controller->commitConfiguration());
+}
+
+TEST_F(ScreensControllerTest, AbortDropsNestedTransactionsAndUnblocksLaterChanges)
+{
+    controller->beginConfiguration();
+    controller->beginConfiguration();
+    ASSERT_TRUE(controller->setConfiguration(withScale(2.0)));
+
+    // as if the inner commit was skipped
+    controller->abortConfiguration();
+    EXPECT_FALSE(controller->inTransaction());
+    EXPECT_FALSE(controller->commitConfiguration());
+    EXPECT_EQ(0, displayConfigurationController->baseConfigurationChanges);
+
+    ASSERT_TRUE(controller->setConfiguration(withFormFactor(mir_form_factor_tv)));
+    EXPECT_EQ(1, displayConfigurationController->baseConfigurationChanges);
+}
+
+TEST_F(ScreensControllerTest, RemovingAScreenDropsThePendingConfiguration)
+{
+    controller->beginConfiguration();
+    ASSERT_TRUE(controller->setConfiguration(withScale(2.0)));
+
+    std::vector<mg::DisplayConfigurationOutput> config{fakeOutput1};
+    std::vector<MockGLDisplayBuffer*> bufferConfig;
+    display->setFakeConfiguration(config, bufferConfig);
+    screensModel->update();
+
+    EXPECT_FALSE(controller->inTransaction());
+    EXPECT_EQ(1, controller->configuration().count());
+    EXPECT_FALSE(controller->commitConfiguration());
+    EXPECT_EQ(0, displayConfigurationController->baseConfigurationChanges);
+}
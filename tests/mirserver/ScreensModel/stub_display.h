@@ -45,8 +45,18 @@ public:
         }
     }
 
+    void for_each_output(std::function<void(mg::UserDisplayConfigurationOutput&)> f) override
+    {
+        for (auto &config : m_config) {
+            mg::UserDisplayConfigurationOutput userConfig(config);
+            f(userConfig);
+        }
+    }
+
+    bool valid() const override { return true; }
+
 private:
-    const std::vector<mg::DisplayConfigurationOutput> m_config;
+    std::vector<mg::DisplayConfigurationOutput> m_config;
 };
 
 
@@ -21,10 +21,15 @@
 
 class StubDisplayConfigurationController : public mir::shell::DisplayConfigurationController
 {
+public:
+    // Every base configuration change stops and restarts the compositor, and so the Qt renderer
     std::future<void> set_base_configuration(
         std::shared_ptr<mir::graphics::DisplayConfiguration> const&) override {
+        ++baseConfigurationChanges;
         return std::future<void>();
     }
+
+    int baseConfigurationChanges{0};
 };
 
 #endif // STUBDISPLAYCONFIGURATIONCONTROLLER_H
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <surfaceobserver.h>
+
+#include <miral/window_specification.h>
+#include <mir/test/doubles/stub_surface.h>
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+
+using StubSurface = mir::test::doubles::StubSurface;
+
+namespace {
+class TestSurfaceObserver : public SurfaceObserver
+{
+public:
+    void frame_posted(int, mir::geometry::Size const&) override {}
+};
+}
+
+TEST(SurfaceObserverTest, ObserverIsFoundUntilItIsDestroyed)
+{
+    auto surface = std::make_shared<StubSurface>();
+    auto observer = std::make_shared<TestSurfaceObserver>();
+    SurfaceObserver::registerObserverForSurface(observer, surface.get());
+
+    EXPECT_EQ(observer, SurfaceObserver::observerForSurface(surface.get()));
+
+    observer.reset();
+    EXPECT_EQ(nullptr, SurfaceObserver::observerForSurface(surface.get()));
+}
+
+TEST(SurfaceObserverTest, DestroyingReplacedObserverKeepsItsReplacement)
+{
+    auto surface = std::make_shared<StubSurface>();
+    auto oldObserver = std::make_shared<TestSurfaceObserver>();
+    auto newObserver = std::make_shared<TestSurfaceObserver>();
+
+    SurfaceObserver::registerObserverForSurface(oldObserver, surface.get());
+    SurfaceObserver::registerObserverForSurface(newObserver, surface.get());
+    oldObserver.reset();
+
+    EXPECT_EQ(newObserver, SurfaceObserver::observerForSurface(surface.get()));
+}
+
+/*
+ * Surfaces and their observers are created and destroyed on one thread while others look observers up and
+ * notify them of modifications, like WindowManagementPolicy::handle_modify_window does on Mir threads.
+ * Most useful when built with -DECM_ENABLE_SANITIZERS=thread
+ */
+TEST(SurfaceObserverTest, ConcurrentRegistrationAndLookup)
+{
+    const int surfaceCount = 4000;
+    const int liveSurfaces = 64;
+    const int lookupThreads = 3;
+
+    // Surfaces recently created, the lookup threads pick from these. They may be gone already,
+    // in which case their address is only used as a key, like a stale miral::Window would.
+    std::array<std::atomic<const mir::scene::Surface*>, liveSurfaces> published;
+    for (auto &surface : published) {
+        surface = nullptr;
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int> started{0};
+    std::atomic<int> notified{0};
+
+    std::vector<std::thread> lookups;
+    for (int t = 0; t < lookupThreads; ++t) {
+        lookups.emplace_back([&, t]() {
+            std::mt19937 random(t);
+            std::uniform_int_distribution<int> slot(0, liveSurfaces - 1);
+            miral::WindowSpecification modifications;
+            modifications.name() = "renamed";
+
+            ++started;
+            while (!done) {
+                if (auto observer = SurfaceObserver::observerForSurface(published[slot(random)])) {
+                    observer->notifySurfaceModifications(modifications);
+                    ++notified;
+                }
+            }
+        });
+    }
+
+    while (started < lookupThreads) {
+        std::this_thread::yield();
+    }
+
+    // the observer of a pair goes before its surface, so addresses are only reused once unregistered
+    std::deque<std::pair<std::shared_ptr<StubSurface>, std::shared_ptr<SurfaceObserver>>> alive;
+    for (int i = 0; i < surfaceCount; ++i) {
+        auto surface = std::make_shared<StubSurface>();
+        auto observer = std::make_shared<TestSurfaceObserver>();
+        SurfaceObserver::registerObserverForSurface(observer, surface.get());
+        published[i % liveSurfaces] = surface.get();
+        alive.emplace_back(surface, observer);
+
+        if (alive.size() > liveSurfaces / 2) {
+            alive.pop_front();
+        }
+    }
+    alive.clear();
+
+    done = true;
+    for (auto &thread : lookups) {
+        thread.join();
+    }
+
+    EXPECT_GT(notified.load(), 0);
+    for (auto &surface : published) {
+        EXPECT_EQ(nullptr, SurfaceObserver::observerForSurface(surface));
+    }
+}
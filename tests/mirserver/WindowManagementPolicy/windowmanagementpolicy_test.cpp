@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <windowmanagementpolicy.h>
+
+#include <miral/application.h>
+#include <miral/window_manager_tools.h>
+#include <mir/scene/surface_creation_parameters.h>
+#include <mir/test/doubles/stub_session.h>
+#include <mir/test/doubles/stub_surface.h>
+
+#include <QGuiApplication>
+
+#include <thread>
+
+using namespace qtmir;
+using namespace testing;
+
+class WindowManagementPolicyTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        setenv("QT_QPA_PLATFORM", "minimal", 1);
+        int argc = 0;
+        char **argv = nullptr;
+        app = new QGuiApplication(argc, argv);
+
+        // Only the advise_* calls not relying on the window manager tools are made
+        policy = new WindowManagementPolicy(miral::WindowManagerTools{nullptr}, notifier, controller, appNotifier);
+
+        const miral::Application application{std::make_shared<mir::test::doubles::StubSession>()};
+        const miral::Window window{application, std::make_shared<mir::test::doubles::StubSurface>()};
+        windowInfo = miral::WindowInfo{window, mir::scene::SurfaceCreationParameters()};
+        windowInfo.userdata() = std::make_shared<ExtraWindowInfo>();
+
+        QObject::connect(&notifier, &WindowModelNotifier::windowsChanged, &receiver,
+                         [this](const WindowModelChanges &changes) {
+                             for (const auto &move : changes.moved) {
+                                 received << QStringLiteral("moved %1").arg(move.second.x());
+                             }
+                             for (const auto &stateChange : changes.stateChanged) {
+                                 received << QStringLiteral("state %1").arg(stateChange.second);
+                             }
+                         }, Qt::QueuedConnection);
+    }
+
+    void TearDown() override
+    {
+        delete policy;
+        delete app;
+    }
+
+    // As MirAL does for every operation made with the window manager lock held
+    void moveInTransaction(int x)
+    {
+        policy->advise_begin();
+        policy->advise_move_to(windowInfo, Point{X{x}, Y{x}});
+        policy->advise_end();
+    }
+
+    void flushEvents()
+    {
+        app->sendPostedEvents();
+        app->sendPostedEvents();
+    }
+
+    QGuiApplication *app;
+    WindowModelNotifier notifier;
+    WindowController controller;
+    AppNotifier appNotifier;
+    WindowManagementPolicy *policy;
+    miral::WindowInfo windowInfo;
+
+    QObject receiver;
+    QStringList received;
+};
+
+TEST_F(WindowManagementPolicyTest, MovesOfAnInteractiveMoveAreCoalesced)
+{
+    // Mir handles the pointer motions of a drag on its own threads
+    std::thread mirThread([this]() {
+        for (int x = 1; x <= 100; ++x) {
+            moveInTransaction(x);
+        }
+    });
+    mirThread.join();
+    flushEvents();
+
+    EXPECT_THAT(received, ElementsAre("moved 100"));
+    EXPECT_EQ(99u, notifier.collapsedMoves());
+}
+
+TEST_F(WindowManagementPolicyTest, MovesAreDeliveredAheadOfLaterTransactionChanges)
+{
+    std::thread mirThread([this]() {
+        for (int x = 1; x <= 10; ++x) {
+            moveInTransaction(x);
+        }
+
+        policy->advise_begin();
+        policy->advise_state_change(windowInfo, mir_window_state_maximized);
+        policy->advise_end();
+
+        moveInTransaction(20);
+    });
+    mirThread.join();
+    flushEvents();
+
+    EXPECT_THAT(received, ElementsAre("moved 10",
+                                      QStringLiteral("state %1").arg(Mir::MaximizedState),
+                                      "moved 20"));
+}
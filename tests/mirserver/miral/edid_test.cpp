@@ -17,7 +17,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <numeric>
+#include <fstream>
 
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "display_identity_cache.h"
 #include "edid.h"
 
 using namespace miral;
@@ -166,3 +171,247 @@ TEST_P(EdidTest, CheckData)
 INSTANTIATE_TEST_CASE_P(AllEdidTests,
                         EdidTest,
                         ::testing::ValuesIn(testData));
+
+namespace {
+std::string makeTempDir()
+{
+    char path[] = "/tmp/qtmir-edid-test-XXXXXX";
+    return mkdtemp(path);
+}
+}
+
+class DisplayIdentityCacheTest : public ::testing::TestWithParam<TestDataParamType>
+{
+protected:
+    void SetUp() override
+    {
+        tempDir = makeTempDir();
+        path = tempDir + "/qtmir/displays.conf";
+    }
+
+    void TearDown() override
+    {
+        unlink(path.c_str());
+        rmdir((tempDir + "/qtmir").c_str());
+        rmdir(tempDir.c_str());
+    }
+
+    DisplaySettings someSettings() const
+    {
+        DisplaySettings settings;
+        settings.width = 1920;
+        settings.height = 1080;
+        settings.refresh_rate = 59.94;
+        settings.scale = 1.5f;
+        settings.orientation = 90;
+        settings.form_factor = 3;
+        return settings;
+    }
+
+    std::string tempDir;
+    std::string path;
+};
+
+TEST_P(DisplayIdentityCacheTest, IdentifiesMonitorFromEdid)
+{
+    const std::vector<uint8_t>& data = std::get<0>(GetParam());
+    DisplayIdentityCache cache{path};
+
+    DisplayId id = cache.identify(data);
+
+    EXPECT_TRUE(id.is_valid());
+    EXPECT_EQ(id.vendor, std::get<1>(GetParam()));
+    EXPECT_EQ(id.product_code, std::get<3>(GetParam()));
+    EXPECT_EQ(id.serial_number, std::get<4>(GetParam()));
+    EXPECT_EQ(id, cache.identify(data));
+}
+
+TEST_P(DisplayIdentityCacheTest, MalformedEdidHasNoIdentity)
+{
+    std::vector<uint8_t> invalid{std::get<0>(GetParam())};
+    invalid[8] = invalid[8]+1;
+
+    DisplayIdentityCache cache{path};
+
+    EXPECT_FALSE(cache.identify(invalid).is_valid());
+    EXPECT_FALSE(cache.identify({}).is_valid());
+    EXPECT_FALSE(cache.store(cache.identify(invalid), someSettings()));
+}
+
+TEST_P(DisplayIdentityCacheTest, StoreAndLookup)
+{
+    DisplayIdentityCache cache{path};
+    DisplayId id = cache.identify(std::get<0>(GetParam()));
+
+    DisplaySettings settings;
+    EXPECT_FALSE(cache.lookup(id, settings));
+
+    EXPECT_TRUE(cache.store(id, someSettings()));
+    EXPECT_FALSE(cache.store(id, someSettings())); // unchanged
+
+    ASSERT_TRUE(cache.lookup(id, settings));
+    EXPECT_EQ(settings, someSettings());
+}
+
+TEST_P(DisplayIdentityCacheTest, SettingsSurviveSaveAndLoad)
+{
+    DisplayId id;
+    {
+        DisplayIdentityCache cache{path};
+        id = cache.identify(std::get<0>(GetParam()));
+        cache.store(id, someSettings());
+        cache.save();
+    }
+
+    DisplayIdentityCache cache{path};
+    cache.load();
+
+    DisplaySettings settings;
+    ASSERT_TRUE(cache.lookup(id, settings));
+    EXPECT_EQ(settings, someSettings());
+}
+
+TEST(DisplayIdentityCacheTest, LayoutIsKeyedByMonitorSet)
+{
+    DisplayIdentityCache cache{"/nonexistent/qtmir/displays.conf"};
+    DisplayId laptop = cache.identify(std::get<0>(testData[0]));
+    DisplayId monitor = cache.identify(std::get<0>(testData[1]));
+
+    DisplayPlacement laptopPlacement{laptop, 1920, 0};
+    DisplayPlacement monitorPlacement{monitor, 0, 0};
+    EXPECT_TRUE(cache.store_layout({laptopPlacement, monitorPlacement}));
+    EXPECT_FALSE(cache.store_layout({laptopPlacement, monitorPlacement})); // unchanged
+
+    DisplayLayout layout;
+    ASSERT_TRUE(cache.lookup_layout({monitor, laptop}, layout)); // order doesn't matter
+    ASSERT_EQ(layout.size(), 2u);
+    EXPECT_EQ(layout[0], laptopPlacement);
+    EXPECT_EQ(layout[1], monitorPlacement);
+
+    EXPECT_FALSE(cache.lookup_layout({laptop}, layout));
+    EXPECT_FALSE(cache.store_layout({laptopPlacement, DisplayPlacement{}})); // unidentified monitor
+}
+
+TEST(DisplayIdentityCacheTest, IdenticalMonitorsKeepTheirOwnPlacement)
+{
+    DisplayIdentityCache cache{"/nonexistent/qtmir/displays.conf"};
+    DisplayId laptop = cache.identify(std::get<0>(testData[0]));
+    DisplayId left = cache.identify(std::get<0>(testData[1]));
+    DisplayId right = cache.identify(std::get<0>(testData[1])); // same EDID, so same identity
+    ASSERT_EQ(left, right);
+
+    EXPECT_TRUE(cache.store_layout({DisplayPlacement{left, 0, 0},
+                                    DisplayPlacement{laptop, 3840, 0},
+                                    DisplayPlacement{right, 1920, 0}}));
+
+    DisplayLayout layout;
+    ASSERT_TRUE(cache.lookup_layout({left, laptop, right}, layout));
+
+    DisplayLayout placements;
+    ASSERT_TRUE(match_layout(layout, {left, right, laptop}, placements));
+    ASSERT_EQ(placements.size(), 3u);
+    EXPECT_EQ(placements[0], (DisplayPlacement{left, 0, 0}));
+    EXPECT_EQ(placements[1], (DisplayPlacement{right, 1920, 0}));
+    EXPECT_EQ(placements[2], (DisplayPlacement{laptop, 3840, 0}));
+
+    EXPECT_FALSE(match_layout(layout, {left, laptop}, placements));
+    EXPECT_FALSE(match_layout(layout, {left, laptop, laptop}, placements));
+}
+
+TEST(DisplayIdentityCacheTest, LayoutSurvivesSaveAndLoad)
+{
+    std::string tempDir = makeTempDir();
+    std::string path = tempDir + "/displays.conf";
+
+    DisplayId laptop, monitor;
+    {
+        DisplayIdentityCache cache{path};
+        laptop = cache.identify(std::get<0>(testData[0]));
+        monitor = cache.identify(std::get<0>(testData[1]));
+        cache.store_layout({DisplayPlacement{laptop, 0, 1080}, DisplayPlacement{monitor, 0, 0}});
+        cache.save();
+    }
+
+    DisplayIdentityCache cache{path};
+    cache.load();
+
+    DisplayLayout layout;
+    ASSERT_TRUE(cache.lookup_layout({laptop, monitor}, layout));
+    ASSERT_EQ(layout.size(), 2u);
+    EXPECT_EQ(layout[0], (DisplayPlacement{laptop, 0, 1080}));
+    EXPECT_EQ(layout[1], (DisplayPlacement{monitor, 0, 0}));
+
+    unlink(path.c_str());
+    rmdir(tempDir.c_str());
+}
+
+TEST(DisplayIdentityCacheTest, LoadSkipsCorruptEntries)
+{
+    std::string tempDir = makeTempDir();
+    std::string path = tempDir + "/displays.conf";
+    {
+        std::ofstream file{path};
+        file << "# qtmir display identities v2\n"
+             << "garbage\n"
+             << "display SAM 2262\n"
+             << "layout 2 SAM 2262 808531761 0 0\n"
+             << "display SAM 2262 808531761 1920 1080 60 1 0 3\n";
+    }
+
+    DisplayIdentityCache cache{path};
+    cache.load();
+
+    DisplayId id;
+    id.vendor = "SAM";
+    id.product_code = 2262;
+    id.serial_number = 808531761;
+
+    DisplaySettings settings;
+    ASSERT_TRUE(cache.lookup(id, settings));
+    EXPECT_EQ(settings.width, 1920);
+    EXPECT_EQ(settings.form_factor, 3);
+
+    DisplayLayout layout;
+    EXPECT_FALSE(cache.lookup_layout({id}, layout));
+
+    unlink(path.c_str());
+    rmdir(tempDir.c_str());
+}
+
+TEST(DisplayIdentityCacheTest, FilesOfTheFirstFormatAreLoaded)
+{
+    std::string tempDir = makeTempDir();
+    std::string path = tempDir + "/displays.conf";
+    {
+        // Display records only, without the record type
+        std::ofstream file{path};
+        file << "# qtmir display identities v1\n"
+             << "SAM 2262 808531761 1920 1080 60 1 0 3\n";
+    }
+
+    DisplayIdentityCache cache{path};
+    cache.load();
+
+    DisplayId id;
+    id.vendor = "SAM";
+    id.product_code = 2262;
+    id.serial_number = 808531761;
+
+    DisplaySettings settings;
+    ASSERT_TRUE(cache.lookup(id, settings));
+    EXPECT_EQ(settings.width, 1920);
+    EXPECT_EQ(settings.form_factor, 3);
+
+    unlink(path.c_str());
+    rmdir(tempDir.c_str());
+}
+
+TEST(DisplayIdentityCacheTest, MissingFileLoadsNothing)
+{
+    DisplayIdentityCache cache{"/nonexistent/qtmir/displays.conf"};
+    EXPECT_NO_THROW(cache.load());
+}
+
+INSTANTIATE_TEST_CASE_P(AllDisplayIdentityCacheTests,
+                        DisplayIdentityCacheTest,
+                        ::testing::ValuesIn(testData));
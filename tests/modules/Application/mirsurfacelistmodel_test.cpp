@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fake_mirsurface.h>
+
+#include <Unity/Application/mirsurfacelistmodel.h>
+
+#include <QSignalSpy>
+
+#include <memory>
+#include <vector>
+
+using namespace qtmir;
+namespace unityapp = unity::shell::application;
+
+namespace {
+
+class ConnectionCountingSurface : public FakeMirSurface
+{
+public:
+    int focusedChangedReceivers() const { return receivers(SIGNAL(focusedChanged(bool))); }
+    int destroyedReceivers() const { return receivers(SIGNAL(destroyed(QObject*))); }
+};
+
+QList<MirSurfaceInterface*> surfacesOf(const MirSurfaceListModel &list)
+{
+    QList<MirSurfaceInterface*> surfaces;
+    for (int i = 0; i < list.count(); ++i) {
+        surfaces << static_cast<MirSurfaceInterface*>(const_cast<unityapp::MirSurfaceInterface*>(list.get(i)));
+    }
+    return surfaces;
+}
+
+} // anonymous namespace
+
+TEST(MirSurfaceListModelTests, SurfaceIsConnectedToOnceWhateverTheNumberOfListsContainingIt)
+{
+    ConnectionCountingSurface surface;
+    const int focusedChangedBefore = surface.focusedChangedReceivers();
+    const int destroyedBefore = surface.destroyedReceivers();
+
+    MirSurfaceListModel sessionList;
+    MirSurfaceListModel applicationList;
+    MirSurfaceListModel promptList;
+
+    sessionList.prependSurface(&surface);
+    applicationList.addSurfaceList(&sessionList);
+    promptList.addSurfaceList(&sessionList);
+
+    EXPECT_TRUE(applicationList.contains(&surface));
+    EXPECT_TRUE(promptList.contains(&surface));
+    EXPECT_EQ(focusedChangedBefore + 1, surface.focusedChangedReceivers());
+    EXPECT_EQ(destroyedBefore + 1, surface.destroyedReceivers());
+
+    sessionList.removeSurface(&surface);
+
+    EXPECT_FALSE(applicationList.contains(&surface));
+    EXPECT_FALSE(promptList.contains(&surface));
+    EXPECT_EQ(focusedChangedBefore, surface.focusedChangedReceivers());
+    EXPECT_EQ(destroyedBefore, surface.destroyedReceivers());
+}
+
+TEST(MirSurfaceListModelTests, FocusedSurfaceIsRaisedInEveryList)
+{
+    FakeMirSurface surface1;
+    FakeMirSurface surface2;
+    FakeMirSurface surface3;
+
+    MirSurfaceListModel sessionList;
+    MirSurfaceListModel otherSessionList;
+    MirSurfaceListModel applicationList;
+
+    sessionList.prependSurface(&surface1);
+    sessionList.prependSurface(&surface2);
+    otherSessionList.prependSurface(&surface3);
+    applicationList.addSurfaceList(&sessionList);
+    applicationList.addSurfaceList(&otherSessionList);
+
+    EXPECT_THAT(surfacesOf(applicationList), testing::ElementsAre(&surface3, &surface2, &surface1));
+
+    surface1.setFocused(true);
+
+    EXPECT_THAT(surfacesOf(sessionList), testing::ElementsAre(&surface1, &surface2));
+    EXPECT_THAT(surfacesOf(applicationList), testing::ElementsAre(&surface1, &surface3, &surface2));
+}
+
+TEST(MirSurfaceListModelTests, DestroyedSurfaceLeavesEveryList)
+{
+    auto surface = new FakeMirSurface;
+    FakeMirSurface otherSurface;
+
+    MirSurfaceListModel sessionList;
+    MirSurfaceListModel applicationList;
+    MirSurfaceListModel promptList;
+
+    sessionList.prependSurface(&otherSurface);
+    sessionList.prependSurface(surface);
+    applicationList.addSurfaceList(&sessionList);
+    promptList.addSurfaceList(&applicationList);
+
+    QSignalSpy countSpy(&promptList, &unityapp::MirSurfaceListInterface::countChanged);
+
+    delete surface;
+
+    EXPECT_THAT(surfacesOf(sessionList), testing::ElementsAre(&otherSurface));
+    EXPECT_THAT(surfacesOf(applicationList), testing::ElementsAre(&otherSurface));
+    EXPECT_THAT(surfacesOf(promptList), testing::ElementsAre(&otherSurface));
+    EXPECT_EQ(1, countSpy.count());
+}
+
+TEST(MirSurfaceListModelTests, RemovingASurfaceListRemovesItsSurfacesAsOneBlock)
+{
+    const int surfaceCount = 10;
+    std::vector<std::unique_ptr<FakeMirSurface>> surfaces;
+
+    MirSurfaceListModel sessionList;
+    MirSurfaceListModel otherSessionList;
+    MirSurfaceListModel applicationList;
+
+    FakeMirSurface otherSurface;
+    otherSessionList.prependSurface(&otherSurface);
+    applicationList.addSurfaceList(&otherSessionList);
+    applicationList.addSurfaceList(&sessionList);
+
+    QSignalSpy insertSpy(&applicationList, &QAbstractItemModel::rowsInserted);
+    for (int i = 0; i < surfaceCount; ++i) {
+        surfaces.emplace_back(new FakeMirSurface);
+        sessionList.prependSurface(surfaces.back().get());
+    }
+    EXPECT_EQ(surfaceCount, insertSpy.count());
+    EXPECT_EQ(surfaceCount + 1, applicationList.count());
+
+    QSignalSpy removeSpy(&applicationList, &QAbstractItemModel::rowsRemoved);
+    QSignalSpy countSpy(&applicationList, &unityapp::MirSurfaceListInterface::countChanged);
+
+    applicationList.removeSurfaceList(&sessionList);
+
+    EXPECT_THAT(surfacesOf(applicationList), testing::ElementsAre(&otherSurface));
+    ASSERT_EQ(1, removeSpy.count());
+    EXPECT_EQ(0, removeSpy.at(0).at(1).toInt());
+    EXPECT_EQ(surfaceCount - 1, removeSpy.at(0).at(2).toInt());
+    EXPECT_EQ(1, countSpy.count());
+
+    // No longer tracked
+    FakeMirSurface lateSurface;
+    sessionList.prependSurface(&lateSurface);
+    EXPECT_FALSE(applicationList.contains(&lateSurface));
+}
+
+TEST(MirSurfaceListModelTests, AggregatingManySurfaces)
+{
+    const int sessionCount = 20;
+    const int surfacesPerSession = 20;
+
+    std::vector<std::unique_ptr<FakeMirSurface>> surfaces;
+    std::vector<std::unique_ptr<MirSurfaceListModel>> sessionLists;
+    MirSurfaceListModel applicationList;
+    MirSurfaceListModel promptList;
+
+    for (int i = 0; i < sessionCount; ++i) {
+        sessionLists.emplace_back(new MirSurfaceListModel);
+        applicationList.addSurfaceList(sessionLists.back().get());
+        promptList.addSurfaceList(sessionLists.back().get());
+    }
+
+    for (int i = 0; i < sessionCount * surfacesPerSession; ++i) {
+        surfaces.emplace_back(new FakeMirSurface);
+        sessionLists[i % sessionCount]->prependSurface(surfaces.back().get());
+    }
+
+    ASSERT_EQ(sessionCount * surfacesPerSession, applicationList.count());
+    ASSERT_EQ(sessionCount * surfacesPerSession, promptList.count());
+
+    for (auto &surface : surfaces) {
+        surface->setFocused(true);
+        surface->setFocused(false);
+    }
+
+    EXPECT_EQ(surfaces.back().get(), applicationList.get(0));
+    EXPECT_EQ(surfaces.back().get(), promptList.get(0));
+
+    for (auto &sessionList : sessionLists) {
+        applicationList.removeSurfaceList(sessionList.get());
+    }
+
+    EXPECT_EQ(0, applicationList.count());
+    EXPECT_EQ(sessionCount * surfacesPerSession, promptList.count());
+
+    surfaces.clear();
+
+    EXPECT_EQ(0, promptList.count());
+}
@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtest/gtest.h>
+
+#include <Unity/Application/qmlcachecleaner.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+using namespace qtmir;
+
+namespace {
+
+void populate(const QString &cacheDir, const QString &name, int fileCount)
+{
+    QDir(cacheDir).mkpath(name);
+    for (int i = 0; i < fileCount; ++i) {
+        QFile file(QStringLiteral("%1/%2/%3.qmlc").arg(cacheDir, name).arg(i));
+        file.open(QIODevice::WriteOnly);
+        file.write(QByteArray(1024, 'x'));
+    }
+}
+
+} // anonymous namespace
+
+/*
+  The QML cache of an application is out of the way as soon as it is wiped, and gets deleted in the background
+ */
+TEST(QmlCacheCleanerTests, cacheIsMovedAwayRightAwayAndDeletedInTheBackground)
+{
+    const int cacheCount = 20;
+
+    QTemporaryDir cacheDir;
+    ASSERT_TRUE(cacheDir.isValid());
+
+    for (int i = 0; i < cacheCount; ++i) {
+        populate(cacheDir.path(), QStringLiteral("com.example.app%1").arg(i), 1);
+    }
+    populate(cacheDir.path(), "com.example.fast", 50);
+    populate(cacheDir.path(), "com.example.click_1.2", 50);
+    populate(cacheDir.path(), "com.example.clicker_1.0", 1);
+
+    QmlCacheCleaner cleaner(cacheDir.path());
+    cleaner.waitForDone();
+
+    cleaner.wipe("com.example.fast");
+
+    // The application can be restarted right away with a fresh cache
+    EXPECT_FALSE(QFileInfo::exists(cacheDir.path() + "/com.example.fast"));
+    populate(cacheDir.path(), "com.example.fast", 1);
+
+    cleaner.wipe("com.example.click");
+    EXPECT_FALSE(QFileInfo::exists(cacheDir.path() + "/com.example.click_1.2"));
+    cleaner.waitForDone();
+
+    QStringList entries = QDir(cacheDir.path()).entryList(QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot);
+    EXPECT_EQ(cacheCount + 2, entries.count());
+    EXPECT_TRUE(entries.contains("com.example.fast"));
+    EXPECT_TRUE(entries.contains("com.example.clicker_1.0"));
+    EXPECT_FALSE(entries.contains("com.example.click_1.2"));
+    EXPECT_EQ(1, QDir(cacheDir.path() + "/com.example.fast").entryList(QDir::Files).count());
+}
+
+TEST(QmlCacheCleanerTests, leftoversAreOnlyRemovedWhenAskedTo)
+{
+    QTemporaryDir cacheDir;
+    ASSERT_TRUE(cacheDir.isValid());
+    populate(cacheDir.path(), ".trash-com.example.app-1234-0", 10);
+
+    QmlCacheCleaner cleaner(cacheDir.path());
+    cleaner.waitForDone();
+    EXPECT_TRUE(QFileInfo::exists(cacheDir.path() + "/.trash-com.example.app-1234-0"));
+
+    cleaner.removeLeftovers();
+    cleaner.waitForDone();
+    EXPECT_FALSE(QFileInfo::exists(cacheDir.path() + "/.trash-com.example.app-1234-0"));
+}
+
+TEST(QmlCacheCleanerTests, defaultCacheDirFollowsTheEnvironment)
+{
+    const bool hadCacheHome = qEnvironmentVariableIsSet("XDG_CACHE_HOME");
+    const QByteArray previousCacheHome = qgetenv("XDG_CACHE_HOME");
+
+    QmlCacheCleaner cleaner;
+
+    QTemporaryDir first;
+    QTemporaryDir second;
+    for (const QTemporaryDir *cacheHome : {&first, &second}) {
+        qputenv("XDG_CACHE_HOME", cacheHome->path().toUtf8());
+        populate(cacheHome->path() + "/QML/Apps", "com.example.app", 1);
+
+        cleaner.wipe("com.example.app");
+        cleaner.waitForDone();
+
+        EXPECT_EQ(QStringList(), QDir(cacheHome->path() + "/QML/Apps")
+                  .entryList(QDir::Dirs | QDir::Hidden | QDir::NoDotAndDotDot));
+    }
+
+    if (hadCacheHome) {
+        qputenv("XDG_CACHE_HOME", previousCacheHome);
+    } else {
+        qunsetenv("XDG_CACHE_HOME");
+    }
+}
@@ -16,7 +16,13 @@
 
 #define MIR_INCLUDE_DEPRECATED_EVENT_HEADER
 
-#include <condition_variable>
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <QQmlComponent>
+#include <QQmlEngine>
 #include <QSignalSpy>
 
 #include <Unity/Application/session.h>
@@ -1952,3 +1958,420 @@ TEST_F(ApplicationManagerTests,surfaceFocusRequestGeneratesApplicationFocusReque
 
     EXPECT_EQ(1, focusRequestedSpy.count());
 }
+
+TEST_F(ApplicationManagerTests,processCommandLineIsReadOnceForAllItsConnections)
+{
+    using namespace ::testing;
+    const pid_t procId = 5921;
+    QByteArray cmdLine("/usr/bin/my-app --desktop_file_hint=my-app");
+
+    EXPECT_CALL(procInfo, command_line(procId))
+        .Times(1)
+        .WillOnce(Return(cmdLine));
+
+    bool authed = false;
+    applicationManager.authorizeSession(procId, authed);
+    EXPECT_TRUE(authed);
+
+    authed = false;
+    applicationManager.authorizeSession(procId, authed);
+    EXPECT_TRUE(authed);
+}
+
+TEST_F(ApplicationManagerTests,processCommandLineIsReadAgainWhenItsPidIsReused)
+{
+    using namespace ::testing;
+    const pid_t procId = 5921;
+    QByteArray cmdLine("/usr/bin/my-app --desktop_file_hint=my-app");
+    QByteArray otherCmdLine("/usr/bin/other-app");
+
+    quint64 startTime = 1000;
+    ON_CALL(procInfo, startTime(procId))
+        .WillByDefault(Invoke([&](pid_t) { return startTime; }));
+    EXPECT_CALL(procInfo, command_line(procId))
+        .Times(2)
+        .WillOnce(Return(cmdLine))
+        .WillOnce(Return(otherCmdLine));
+
+    bool authed = false;
+    applicationManager.authorizeSession(procId, authed);
+    EXPECT_TRUE(authed);
+
+    // Another process got that pid meanwhile
+    startTime = 2000;
+    applicationManager.authorizeSession(procId, authed);
+    EXPECT_FALSE(authed);
+}
+
+/*
+ * Many clients connecting at once from their Mir IPC threads all get authorized, while
+ * ubuntu-app-launch, which is not known to be thread-safe, is never called concurrently.
+ */
+TEST_F(ApplicationManagerTests,simultaneousConnectionsAreAuthorizedWithSerializedLookups)
+{
+    using namespace ::testing;
+    const int clientCount = 50;
+    const pid_t firstProcId = 6000;
+
+    std::atomic<int> lookupsInProgress{0};
+    std::atomic<int> concurrentLookups{0};
+
+    EXPECT_CALL(*taskController, start(_, _))
+        .WillRepeatedly(Return(true));
+    ON_CALL(*taskController, appIdHasProcessId(_, _))
+        .WillByDefault(Invoke([&](const QString &appId, pid_t pid) {
+            if (++lookupsInProgress > 1) {
+                ++concurrentLookups;
+            }
+            std::this_thread::yield();
+            --lookupsInProgress;
+            return appId == QStringLiteral("app%1").arg(pid - firstProcId);
+        }));
+
+    for (int i = 0; i < clientCount; ++i) {
+        applicationManager.startApplication(QStringLiteral("app%1").arg(i));
+    }
+
+    std::promise<void> go;
+    std::shared_future<void> launched(go.get_future());
+    std::vector<char> authorized(clientCount, false);
+    std::vector<std::thread> clients;
+
+    for (int i = 0; i < clientCount; ++i) {
+        clients.emplace_back([&, i] {
+            launched.wait();
+            bool authed = false;
+            applicationManager.authorizeSession(firstProcId + i, authed);
+            authorized[i] = authed;
+        });
+    }
+
+    go.set_value();
+    for (auto &client : clients) {
+        client.join();
+    }
+
+    for (int i = 0; i < clientCount; ++i) {
+        EXPECT_TRUE(authorized[i]) << "client " << i;
+    }
+    EXPECT_EQ(0, concurrentLookups);
+}
+
+/*
+ * Lookups by appId and mir session go through indexes, which must follow applications and sessions as they
+ * come and go
+ */
+TEST_F(ApplicationManagerTests,lookupsFindEveryRunningApplication)
+{
+    using namespace ::testing;
+    const int appCount = 200;
+    const pid_t firstProcId = 7000;
+
+    EXPECT_CALL(*taskController, start(_, _))
+        .WillRepeatedly(Return(true));
+    ON_CALL(*taskController, appIdHasProcessId(_, _))
+        .WillByDefault(Invoke([&](const QString &appId, pid_t pid) {
+            return appId == QStringLiteral("app%1").arg(pid - firstProcId);
+        }));
+
+    std::vector<miral::ApplicationInfo> appInfos;
+    for (int i = 0; i < appCount; ++i) {
+        const QString appId = QStringLiteral("app%1").arg(i);
+        applicationManager.startApplication(appId);
+        applicationManager.onProcessStarting(appId);
+
+        bool authed = false;
+        applicationManager.authorizeSession(firstProcId + i, authed);
+        ASSERT_TRUE(authed);
+
+        appInfos.push_back(createApplicationInfoFor(appId.toStdString(), firstProcId + i));
+        taskController->onSessionStarting(appInfos.back());
+    }
+
+    for (int i = 0; i < appCount; ++i) {
+        Application *application = applicationManager.findApplication(QStringLiteral("app%1").arg(i));
+        ASSERT_NE(nullptr, application);
+        SessionInterface *session = applicationManager.findSession(appInfos[i].application().get());
+        ASSERT_NE(nullptr, session);
+        EXPECT_EQ(firstProcId + i, session->pid());
+        EXPECT_EQ(application, session->application());
+    }
+
+    for (auto &appInfo : appInfos) {
+        taskController->onSessionStopping(appInfo);
+    }
+    EXPECT_EQ(nullptr, applicationManager.findSession(appInfos.front().application().get()));
+}
+
+TEST_F(ApplicationManagerTests,startupTimelineFollowsTheLaunch)
+{
+    using namespace ::testing;
+
+    const QString appId("testAppId");
+    const pid_t procId = 5551;
+
+    ON_CALL(*taskController, appIdHasProcessId(appId, procId)).WillByDefault(Return(true));
+    EXPECT_CALL(*taskController, start(appId, _))
+        .Times(1)
+        .WillOnce(Return(true));
+
+    EXPECT_TRUE(applicationManager.startupTimeline(appId).isEmpty());
+
+    auto app = applicationManager.startApplication(appId);
+    EXPECT_EQ(QStringList({"requested"}), applicationManager.startupTimeline(appId).keys());
+
+    applicationManager.onProcessStarting(appId);
+    bool authed = false;
+    applicationManager.authorizeSession(procId, authed);
+    auto appInfo = createApplicationInfoFor("", procId);
+    taskController->onSessionStarting(appInfo);
+
+    FakeMirSurface surface;
+    onSessionCreatedSurface(appInfo, &surface);
+    EXPECT_FALSE(app->launchTimeline().reached(LaunchTimeline::FirstFrame));
+    surface.setReady();
+
+    ASSERT_EQ(Application::InternalState::Running, app->internalState());
+
+    const QVariantMap timeline = applicationManager.startupTimeline(appId);
+    qreal previous = 0;
+    for (int stage = LaunchTimeline::Requested; stage < LaunchTimeline::StageCount; ++stage) {
+        const char *name = LaunchTimeline::stageName(static_cast<LaunchTimeline::Stage>(stage));
+        ASSERT_TRUE(timeline.contains(name)) << name;
+        EXPECT_LE(previous, timeline[name].toReal()) << name;
+        previous = timeline[name].toReal();
+    }
+    EXPECT_EQ(0, timeline["requested"].toReal());
+}
+
+TEST_F(ApplicationManagerTests,lifecycleLatencyIsTheSlowestOfTheApplicationSessions)
+{
+    using namespace ::testing;
+
+    const QString appId("testAppId");
+    const pid_t procId = 5551;
+    const pid_t childProcId = 5552;
+
+    ON_CALL(*taskController, appIdHasProcessId(appId, _)).WillByDefault(Return(true));
+    EXPECT_CALL(*taskController, start(appId, _))
+        .Times(1)
+        .WillOnce(Return(true));
+
+    EXPECT_TRUE(applicationManager.lifecycleLatency(appId).isEmpty());
+
+    auto app = applicationManager.startApplication(appId);
+    applicationManager.onProcessStarting(appId);
+
+    auto timeSource = QSharedPointer<FakeTimeSource>::create();
+    std::vector<miral::ApplicationInfo> appInfos;
+    std::vector<std::unique_ptr<FakeMirSurface>> surfaces;
+    for (pid_t pid : {procId, childProcId}) {
+        bool authed = false;
+        applicationManager.authorizeSession(pid, authed);
+        ASSERT_TRUE(authed);
+        appInfos.push_back(createApplicationInfoFor("", pid));
+        taskController->onSessionStarting(appInfos.back());
+        auto session = static_cast<qtmir::Session*>(applicationManager.findSession(appInfos.back().application().get()));
+        session->setTimeSource(timeSource);
+        surfaces.emplace_back(new FakeMirSurface);
+        onSessionCreatedSurface(appInfos.back(), surfaces.back().get());
+    }
+    for (auto &surface : surfaces) {
+        surface->setReady();
+    }
+    ASSERT_EQ(2, app->sessions().count());
+    ASSERT_EQ(Application::InternalState::Running, app->internalState());
+
+    app->setRequestedState(Application::RequestedSuspended);
+    ASSERT_EQ(Application::InternalState::SuspendingWaitSession, app->internalState());
+
+    // Only the child draws after being told
+    timeSource->m_msecsSinceReference += 100;
+    Q_EMIT surfaces[1]->framesPosted();
+    static_cast<qtmir::Session*>(app->sessions()[0])->doSuspend();
+    timeSource->m_msecsSinceReference += 200;
+    static_cast<qtmir::Session*>(app->sessions()[1])->doSuspend();
+
+    const QVariantMap latencies = applicationManager.lifecycleLatency(appId);
+    EXPECT_EQ(100, latencies["acknowledge"].toLongLong());
+    EXPECT_EQ(300, latencies["suspend"].toLongLong());
+    EXPECT_EQ(-1, latencies["resume"].toLongLong());
+}
+
+/*
+  Roles changed by several applications in the same event loop iteration are notified
+  with a single dataChanged covering all of them
+ */
+TEST_F(ApplicationManagerTests,roleChangesAreCoalescedIntoOneDataChangedPerIteration)
+{
+    using namespace ::testing;
+
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv);
+
+    auto app1 = startApplication(5551, "testAppId1");
+    FakeMirSurface surface1;
+    surface1.setSession(app1->sessions()[0]);
+    app1->sessions()[0]->registerSurface(&surface1);
+    surface1.setReady();
+    surface1.setFocused(true);
+
+    auto app2 = startApplication(5552, "testAppId2");
+    FakeMirSurface surface2;
+    surface2.setSession(app2->sessions()[0]);
+    app2->sessions()[0]->registerSurface(&surface2);
+    qtApp.processEvents();
+
+    ASSERT_EQ(Application::Starting, app2->state());
+
+    qRegisterMetaType<QVector<int>>();
+    QSignalSpy dataChangedSpy(&applicationManager, &QAbstractItemModel::dataChanged);
+
+    surface2.setReady();
+    surface1.setFocused(false);
+    surface2.setFocused(true);
+
+    EXPECT_EQ(0, dataChangedSpy.count());
+
+    qtApp.processEvents(); // process queued signal-slot connections
+
+    ASSERT_EQ(1, dataChangedSpy.count());
+    QVector<int> roles({ApplicationManager::RoleState, ApplicationManager::RoleFocused});
+    std::sort(roles.begin(), roles.end());
+    EXPECT_EQ(applicationManager.index(0), dataChangedSpy[0][0].value<QModelIndex>());
+    EXPECT_EQ(applicationManager.index(1), dataChangedSpy[0][1].value<QModelIndex>());
+    EXPECT_EQ(roles, dataChangedSpy[0][2].value<QVector<int>>());
+
+    // nothing more to notify
+    qtApp.processEvents();
+    EXPECT_EQ(1, dataChangedSpy.count());
+}
+
+/*
+  Benchmark how many times QML bindings on the application roles get re-evaluated while
+  focus cycles through all the running applications within one event loop iteration
+ */
+TEST_F(ApplicationManagerTests,bindingsAreEvaluatedOncePerCoalescedChange)
+{
+    using namespace ::testing;
+    const int appCount = 50;
+    const int iterations = 20;
+
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv);
+
+    std::vector<std::unique_ptr<FakeMirSurface>> surfaces;
+    for (int i = 0; i < appCount; ++i) {
+        auto app = startApplication(8000 + i, QStringLiteral("app%1").arg(i));
+        surfaces.emplace_back(new FakeMirSurface);
+        surfaces.back()->setSession(app->sessions()[0]);
+        app->sessions()[0]->registerSurface(surfaces.back().get());
+        surfaces.back()->setReady();
+    }
+    qtApp.processEvents();
+
+    QQmlEngine engine;
+    QQmlComponent component(&engine);
+    component.setData(
+        "import QtQml 2.2\n"
+        "import QtQml.Models 2.2\n"
+        "QtObject {\n"
+        "    id: root\n"
+        "    property var model\n"
+        "    property var counter: ({ state: 0, focused: 0 })\n"
+        "    function count(role, value) { counter[role]++; return value; }\n"
+        "    function evaluations(role) { return counter[role]; }\n"
+        "    property Instantiator instantiator: Instantiator {\n"
+        "        model: root.model\n"
+        "        delegate: QtObject {\n"
+        "            property int state: root.count('state', model.state)\n"
+        "            property bool focused: root.count('focused', model.focused)\n"
+        "        }\n"
+        "    }\n"
+        "}\n", QUrl());
+    QScopedPointer<QObject> root(component.beginCreate(engine.rootContext()));
+    ASSERT_TRUE(root) << component.errorString().toStdString();
+    root->setProperty("model", QVariant::fromValue<QObject*>(&applicationManager));
+    component.completeCreate();
+
+    auto evaluations = [&](const char *role) {
+        QVariant count;
+        QMetaObject::invokeMethod(root.data(), "evaluations", Q_RETURN_ARG(QVariant, count), Q_ARG(QVariant, role));
+        return count.toInt();
+    };
+    ASSERT_EQ(appCount, evaluations("focused"));
+
+    QSignalSpy dataChangedSpy(&applicationManager, &QAbstractItemModel::dataChanged);
+
+    for (int n = 0; n < iterations; ++n) {
+        for (int i = 0; i < appCount; ++i) {
+            surfaces[(i + appCount - 1) % appCount]->setFocused(false);
+            surfaces[i]->setFocused(true);
+        }
+        qtApp.processEvents();
+    }
+
+    const int focusedEvaluations = evaluations("focused") - appCount;
+
+    // Every row notified once per iteration instead of once per change, other roles left alone
+    EXPECT_EQ(iterations, dataChangedSpy.count());
+    EXPECT_EQ(iterations * appCount, focusedEvaluations);
+    EXPECT_EQ(appCount, evaluations("state"));
+
+    surfaces.clear();
+}
+
+/*
+ * ubuntu-app-launch is not known to be thread-safe: the application info of a launching application is looked
+ * up by the thread calling startApplication, once the process start was requested
+ */
+TEST_F(ApplicationManagerTests,applicationInfoIsLookedUpOnTheCallingThreadAfterStart)
+{
+    using namespace ::testing;
+
+    const QString appId("testAppId");
+
+    InSequence sequence;
+    EXPECT_CALL(*taskController, start(appId, _))
+        .WillOnce(Return(true));
+    EXPECT_CALL(*taskController, getInfoForApp(appId))
+        .WillOnce(Invoke([&](const QString &appId) {
+            EXPECT_EQ(QThread::currentThread(), applicationManager.thread());
+            return QSharedPointer<qtmir::ApplicationInfo>(new NiceMock<MockApplicationInfo>(appId));
+        }));
+
+    EXPECT_NE(nullptr, applicationManager.startApplication(appId));
+}
+
+TEST_F(ApplicationManagerTests,applicationInfoIsLookedUpOnceWhenTheProcessStartsSynchronously)
+{
+    using namespace ::testing;
+
+    const QString appId("testAppId");
+
+    EXPECT_CALL(*taskController, start(appId, _))
+        .WillOnce(Invoke([&](const QString &appId, const QStringList &) {
+            applicationManager.onProcessStarting(appId);
+            return true;
+        }));
+    EXPECT_CALL(*taskController, getInfoForApp(appId))
+        .Times(1);
+
+    EXPECT_NE(nullptr, applicationManager.startApplication(appId));
+}
+
+TEST_F(ApplicationManagerTests,failedStartDoesNotLookUpTheApplicationInfo)
+{
+    using namespace ::testing;
+
+    const QString appId("testAppId");
+
+    EXPECT_CALL(*taskController, start(appId, _))
+        .WillOnce(Return(false));
+    EXPECT_CALL(*taskController, getInfoForApp(_))
+        .Times(0);
+
+    EXPECT_EQ(nullptr, applicationManager.startApplication(appId));
+}
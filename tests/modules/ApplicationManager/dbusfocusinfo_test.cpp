@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Unity/Application/cgmanager.h>
+#include <Unity/Application/dbusfocusinfo.h>
+
+#include <fake_mirsurface.h>
+#include <qtmir_test.h>
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMetaType>
+#include <QDBusServer>
+#include <QDir>
+#include <QFile>
+#include <QScopedPointer>
+#include <QSemaphore>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <atomic>
+
+using namespace qtmir;
+
+namespace {
+
+const pid_t firstProcId = 6000;
+const pid_t helperOffset = 10000; // every application has a helper process in its cgroup
+
+/*
+  Stand-in for cgmanager, putting each process in a cgroup of its own along with a helper process
+ */
+class FakeCGManager : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.linuxcontainers.cgmanager0_0")
+public:
+    std::atomic<int> calls{0};
+    std::atomic<int> unrelatedPid{-1}; // in no application cgroup
+
+public Q_SLOTS:
+    QString GetPidCgroup(const QString &, int pid)
+    {
+        ++calls;
+        if (pid == unrelatedPid) {
+            return QStringLiteral("/user.slice/user-1000.slice/session-c1.scope");
+        }
+        const int appPid = pid >= firstProcId + helperOffset ? pid - helperOffset : pid;
+        return QStringLiteral("/user.slice/upstart/application-legacy-app%1-").arg(appPid);
+    }
+
+    QList<int> GetTasks(const QString &, const QString &cgroup)
+    {
+        ++calls;
+        const int appPid = cgroup.section('-', -2, -2).mid(3).toInt();
+        return QList<int>({appPid, appPid + helperOffset});
+    }
+};
+
+class FakeCGManagerPeer : public QThread
+{
+public:
+    explicit FakeCGManagerPeer(const QString &address) : m_address(address)
+    {
+        start();
+        m_ready.acquire();
+    }
+
+    ~FakeCGManagerPeer()
+    {
+        quit();
+        wait();
+    }
+
+    int calls() const { return m_cgmanager ? m_cgmanager->calls.load() : 0; }
+    void setUnrelatedPid(int pid) { m_cgmanager.load()->unrelatedPid = pid; }
+
+protected:
+    void run() override
+    {
+        qDBusRegisterMetaType<QList<int>>();
+
+        QDBusServer server(m_address);
+        FakeCGManager cgmanager;
+        QList<QDBusConnection> connections;
+        QObject::connect(&server, &QDBusServer::newConnection, &cgmanager, [&](const QDBusConnection &connection) {
+            connections << connection;
+            connections.last().registerObject("/org/linuxcontainers/cgmanager", &cgmanager,
+                                              QDBusConnection::ExportAllSlots);
+        }, Qt::DirectConnection);
+        m_cgmanager = &cgmanager;
+        m_ready.release();
+
+        exec();
+        m_cgmanager = nullptr;
+    }
+
+private:
+    const QString m_address;
+    QSemaphore m_ready;
+    std::atomic<FakeCGManager*> m_cgmanager{nullptr};
+};
+
+class FocusedMirSurface : public FakeMirSurface
+{
+public:
+    bool activeFocus() const override { return true; }
+};
+
+} // anonymous namespace
+
+class DBusFocusInfoTests : public ::testing::QtMirTest
+{
+public:
+    DBusFocusInfoTests()
+        : peerAddress(QStringLiteral("unix:path=%1/cgmanager").arg(tempDir.path()))
+    {}
+
+    CGManager *createCGManager(const QString &address)
+    {
+        return new CGManager(address, tempDir.path() + "/proc", tempDir.path() + "/cgroup");
+    }
+
+    // Only the start time matters, the other fields are left to 0
+    void writeProcStat(pid_t pid, quint64 startTime)
+    {
+        QDir(tempDir.path()).mkpath(QStringLiteral("proc/%1").arg(pid));
+        QFile statFile(QStringLiteral("%1/proc/%2/stat").arg(tempDir.path()).arg(pid));
+        ASSERT_TRUE(statFile.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QByteArray stat = QStringLiteral("%1 (helper) S").arg(pid).toLatin1();
+        for (int field = 4; field < 22; ++field) {
+            stat += " 0";
+        }
+        stat += " " + QByteArray::number(startTime) + " 0 0\n";
+        statFile.write(stat);
+    }
+
+    QTemporaryDir tempDir;
+    const QString peerAddress;
+};
+
+TEST_F(DBusFocusInfoTests, pidsAreResolvedOnceUntilSessionsChange)
+{
+    const int appCount = 50;
+
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv);
+
+    FakeCGManagerPeer peer(peerAddress);
+
+    QList<Application*> applications;
+    for (int i = 0; i < appCount; ++i) {
+        applications << startApplication(firstProcId + i, QStringLiteral("app%1").arg(i));
+    }
+
+    DBusFocusInfo focusInfo(applications, createCGManager(peerAddress));
+
+    QList<uint> pids;
+    for (int i = 0; i < appCount; ++i) {
+        pids << firstProcId + i;
+    }
+
+    auto queryAll = [&]() {
+        for (uint pid : pids) {
+            EXPECT_FALSE(focusInfo.isPidFocused(pid));
+        }
+    };
+
+    queryAll();
+    EXPECT_EQ(2 * appCount, peer.calls());
+
+    queryAll();
+    EXPECT_EQ(2 * appCount, peer.calls());
+
+    // Processes sharing the cgroup of an application are known already
+    EXPECT_FALSE(focusInfo.isPidFocused(firstProcId + helperOffset));
+    EXPECT_EQ(2 * appCount, peer.calls());
+
+    focusInfo.invalidatePidCache();
+
+    const QList<bool> focused = focusInfo.arePidsFocused(pids + pids);
+    EXPECT_EQ(QVector<bool>(2 * appCount, false).toList(), focused);
+    EXPECT_EQ(4 * appCount, peer.calls());
+
+    EXPECT_EQ(QList<bool>({true, false}),
+              focusInfo.arePidsFocused({(uint)QCoreApplication::applicationPid(), firstProcId}));
+}
+
+TEST_F(DBusFocusInfoTests, cachedPidsAreDroppedOnceReusedByAnotherProcess)
+{
+    int argc = 0;
+    char* argv[0];
+    QCoreApplication qtApp(argc, argv);
+
+    FakeCGManagerPeer peer(peerAddress);
+
+    QList<Application*> applications;
+    applications << startApplication(firstProcId, QStringLiteral("app0"));
+    FocusedMirSurface surface;
+    applications.first()->sessions().first()->registerSurface(&surface);
+    surface.setReady();
+
+    DBusFocusInfo focusInfo(applications, createCGManager(peerAddress));
+
+    const pid_t helperPid = firstProcId + helperOffset;
+    writeProcStat(helperPid, 100);
+
+    EXPECT_TRUE(focusInfo.isPidFocused(helperPid));
+    const int calls = peer.calls();
+    EXPECT_TRUE(focusInfo.isPidFocused(helperPid));
+    EXPECT_EQ(calls, peer.calls());
+
+    // The helper exits and an unrelated process gets its pid
+    peer.setUnrelatedPid(helperPid);
+    writeProcStat(helperPid, 200);
+    EXPECT_FALSE(focusInfo.isPidFocused(helperPid));
+
+    // That negative answer does not stick either once the pid is reused by a process of the application
+    peer.setUnrelatedPid(-1);
+    writeProcStat(helperPid, 300);
+    EXPECT_TRUE(focusInfo.isPidFocused(helperPid));
+}
+
+TEST_F(DBusFocusInfoTests, cgroupsAreReadFromProcWithoutCGManager)
+{
+    const pid_t pid = 1234;
+
+    QDir(tempDir.path()).mkpath(QStringLiteral("proc/%1").arg(pid));
+    QFile cgroupFile(QStringLiteral("%1/proc/%2/cgroup").arg(tempDir.path()).arg(pid));
+    ASSERT_TRUE(cgroupFile.open(QIODevice::WriteOnly));
+    cgroupFile.write("11:cpu,cpuacct:/user.slice\n"
+                     "7:freezer:/user.slice/upstart/application-legacy-app-\n"
+                     "0::/user.slice/app.scope\n");
+    cgroupFile.close();
+
+    QDir(tempDir.path()).mkpath("cgroup/freezer/user.slice/upstart/application-legacy-app-");
+    QFile tasksFile(tempDir.path() + "/cgroup/freezer/user.slice/upstart/application-legacy-app-/tasks");
+    ASSERT_TRUE(tasksFile.open(QIODevice::WriteOnly));
+    tasksFile.write("1234\n1240\n");
+    tasksFile.close();
+
+    QDir(tempDir.path()).mkpath("cgroup/user.slice/app.scope");
+    QFile procsFile(tempDir.path() + "/cgroup/user.slice/app.scope/cgroup.procs");
+    ASSERT_TRUE(procsFile.open(QIODevice::WriteOnly));
+    procsFile.write("1234\n");
+    procsFile.close();
+
+    // Nobody listening there
+    QScopedPointer<CGManager> cgManager(createCGManager(peerAddress));
+
+    EXPECT_EQ("/user.slice/upstart/application-legacy-app-", cgManager->getCGroupOfPid("freezer", pid));
+    EXPECT_EQ(QSet<pid_t>({1234, 1240}),
+              cgManager->getTasks("freezer", "/user.slice/upstart/application-legacy-app-"));
+
+    EXPECT_EQ("/user.slice", cgManager->getCGroupOfPid("cpuacct", pid));
+
+    // Unified cgroup v2 hierarchy for controllers without one of their own
+    EXPECT_EQ("/user.slice/app.scope", cgManager->getCGroupOfPid("memory", pid));
+    EXPECT_EQ(QSet<pid_t>({1234}), cgManager->getTasks("memory", "/user.slice/app.scope"));
+
+    EXPECT_EQ(QString(), cgManager->getCGroupOfPid("freezer", pid + 1));
+}
+
+#include "dbusfocusinfo_test.moc"
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Unity/Application/memorypolicy.h>
+#include <Unity/Application/session.h>
+
+#include <fake_mirsurface.h>
+#include <qtmir_test.h>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <memory>
+
+using namespace qtmir;
+
+namespace {
+
+struct FakeMemoryPressureSource : public MemoryPressureSource
+{
+    bool read(MemoryPressure &value) override
+    {
+        value = pressure;
+        return known;
+    }
+
+    MemoryPressure pressure;
+    bool known{true};
+};
+
+// Way above the kernel's pid_max, so that terminating these fake processes can't hit a real one
+const pid_t firstProcId = 0x7fff0000;
+
+} // anonymous namespace
+
+class MemoryPolicyTest : public ::testing::QtMirTest
+{
+public:
+    MemoryPolicyTest()
+        : qtApp(argc, argv)
+        , pressureSource(new FakeMemoryPressureSource)
+        , memoryPolicy(&applicationManager,
+                       pressureSource,
+                       QSharedPointer<ProcInfo>(&procInfo, [](ProcInfo *){}),
+                       QSharedPointer<SettingsInterface>(&settings, [](SettingsInterface *){}))
+        , timeSource(new FakeTimeSource)
+    {
+        memoryPolicy.setTimeSource(timeSource);
+    }
+
+    void waitForCooldown()
+    {
+        timeSource->m_msecsSinceReference += memoryPolicy.thresholds().cooldownMs;
+    }
+
+    Application *startRunningApplication(const QString &appId)
+    {
+        using namespace ::testing;
+
+        const pid_t procId = firstProcId + surfaces.size();
+        ON_CALL(*taskController, appIdHasProcessId(appId, procId)).WillByDefault(Return(true));
+        EXPECT_CALL(*taskController, start(appId, _))
+            .WillOnce(Return(true));
+
+        auto application = applicationManager.startApplication(appId);
+        applicationManager.onProcessStarting(appId);
+        bool authed = false;
+        applicationManager.authorizeSession(procId, authed);
+
+        auto appSession = std::make_shared<mir::scene::MockSession>(appId.toStdString(), procId);
+        miral::ApplicationInfo appInfo(appSession);
+        taskController->onSessionStarting(appInfo);
+        appInfos.push_back(appInfo);
+
+        surfaces.emplace_back(new FakeMirSurface);
+        applicationManager.findSession(appSession.get())->registerSurface(surfaces.back().get());
+        surfaces.back()->setReady();
+
+        EXPECT_EQ(Application::InternalState::Running, application->internalState());
+        return application;
+    }
+
+    void suspendApplication(Application *application)
+    {
+        application->setRequestedState(Application::RequestedSuspended);
+        static_cast<Session*>(application->sessions()[0])->doSuspend();
+        applicationManager.onProcessSuspended(application->appId());
+        ASSERT_EQ(Application::InternalState::Suspended, application->internalState());
+    }
+
+    // As Mir and upstart report a process killed by a signal
+    void processKilled(Application *application)
+    {
+        const int index = application->sessions()[0]->pid() - firstProcId;
+        taskController->onSessionStopping(appInfos[index]);
+        applicationManager.onProcessFailed(application->appId(), TaskController::Error::APPLICATION_CRASHED);
+        applicationManager.onProcessStopped(application->appId());
+    }
+
+    void focus(Application *application)
+    {
+        for (auto &surface : surfaces) {
+            surface->setFocused(false);
+        }
+        static_cast<FakeMirSurface*>(application->surfaceList()->get(0))->setFocused(true);
+        qtApp.processEvents(); // process queued signal-slot connections
+    }
+
+protected:
+    void SetUp() override {
+        if (m_tempDir.isValid()) qputenv("XDG_CACHE_HOME", m_tempDir.path().toUtf8());
+    }
+
+public:
+    const QTemporaryDir m_tempDir;
+    int argc{0};
+    char **argv{nullptr};
+    QCoreApplication qtApp;
+    QSharedPointer<FakeMemoryPressureSource> pressureSource;
+    MemoryPolicy memoryPolicy;
+    QSharedPointer<FakeTimeSource> timeSource;
+    std::vector<std::unique_ptr<FakeMirSurface>> surfaces;
+    std::vector<miral::ApplicationInfo> appInfos;
+};
+
+TEST_F(MemoryPolicyTest, leavesApplicationsAloneWithoutMemoryPressure)
+{
+    startRunningApplication("app1");
+    startRunningApplication("app2");
+
+    EXPECT_EQ(nullptr, memoryPolicy.evaluate());
+
+    pressureSource->known = false;
+    pressureSource->pressure.some = 100;
+    pressureSource->pressure.full = 100;
+    EXPECT_EQ(nullptr, memoryPolicy.evaluate());
+}
+
+TEST_F(MemoryPolicyTest, suspendsBackgroundApplicationsLeastRecentlyUsedFirst)
+{
+    auto app1 = startRunningApplication("app1");
+    auto app2 = startRunningApplication("app2");
+    auto app3 = startRunningApplication("app3");
+
+    focus(app2);
+    focus(app1);
+    focus(app3);
+
+    pressureSource->pressure.some = memoryPolicy.thresholds().suspendPressure;
+
+    EXPECT_EQ(app2, memoryPolicy.evaluate());
+    EXPECT_EQ(Application::RequestedSuspended, app2->requestedState());
+
+    waitForCooldown();
+    EXPECT_EQ(app1, memoryPolicy.evaluate());
+    EXPECT_EQ(Application::RequestedSuspended, app1->requestedState());
+
+    // the focused application is never touched
+    waitForCooldown();
+    EXPECT_EQ(nullptr, memoryPolicy.evaluate());
+    EXPECT_EQ(Application::RequestedRunning, app3->requestedState());
+}
+
+TEST_F(MemoryPolicyTest, focusingSuspendedApplicationRequestsItRunningAgain)
+{
+    auto app1 = startRunningApplication("app1");
+    auto app2 = startRunningApplication("app2");
+    focus(app2);
+
+    pressureSource->pressure.some = 50;
+    ASSERT_EQ(app1, memoryPolicy.evaluate());
+    ASSERT_EQ(Application::RequestedSuspended, app1->requestedState());
+
+    focus(app1);
+
+    EXPECT_EQ(Application::RequestedRunning, app1->requestedState());
+}
+
+TEST_F(MemoryPolicyTest, exemptApplicationsAreLeftAlone)
+{
+    auto music = startRunningApplication("com.ubuntu.music"); // exempt in MockSettings
+    auto exempt = startRunningApplication("app1");
+    exempt->setExemptFromLifecycle(true);
+    auto app2 = startRunningApplication("app2");
+    focus(app2);
+
+    pressureSource->pressure.some = 100;
+    pressureSource->pressure.full = 100;
+
+    EXPECT_EQ(nullptr, memoryPolicy.evaluate());
+    EXPECT_EQ(Application::RequestedRunning, music->requestedState());
+    EXPECT_EQ(Application::RequestedRunning, exempt->requestedState());
+}
+
+TEST_F(MemoryPolicyTest, terminatesOneSuspendedApplicationPerPressureWindow)
+{
+    auto app1 = startRunningApplication("app1");
+    auto app2 = startRunningApplication("app2");
+    auto app3 = startRunningApplication("app3");
+    auto app4 = startRunningApplication("app4");
+    focus(app1);
+    focus(app2);
+    focus(app3);
+    focus(app4);
+    suspendApplication(app1);
+    suspendApplication(app2);
+
+    // The 10 seconds average stays high for a while after memory got freed
+    pressureSource->pressure.full = memoryPolicy.thresholds().terminatePressure;
+
+    EXPECT_EQ(app1, memoryPolicy.evaluate());
+    for (int i = 0; i < 9; ++i) {
+        timeSource->m_msecsSinceReference += 1000;
+        EXPECT_EQ(nullptr, memoryPolicy.evaluate());
+    }
+
+    timeSource->m_msecsSinceReference += 1000;
+    EXPECT_EQ(app2, memoryPolicy.evaluate());
+
+    // never the same one twice, nor one that is running
+    waitForCooldown();
+    EXPECT_EQ(nullptr, memoryPolicy.evaluate());
+    EXPECT_EQ(Application::InternalState::Running, app3->internalState());
+}
+
+TEST_F(MemoryPolicyTest, runningApplicationsAreSuspendedRatherThanTerminated)
+{
+    auto app1 = startRunningApplication("app1");
+    auto app2 = startRunningApplication("app2");
+    focus(app2);
+
+    pressureSource->pressure.some = 100;
+    pressureSource->pressure.full = 100;
+
+    EXPECT_EQ(app1, memoryPolicy.evaluate());
+    EXPECT_EQ(Application::RequestedSuspended, app1->requestedState());
+}
+
+TEST_F(MemoryPolicyTest, terminatedApplicationsStayResumable)
+{
+    auto app1 = startRunningApplication("app1");
+    auto app2 = startRunningApplication("app2");
+    focus(app2);
+    suspendApplication(app1);
+
+    pressureSource->pressure.full = 100;
+    ASSERT_EQ(app1, memoryPolicy.evaluate());
+
+    processKilled(app1);
+
+    EXPECT_EQ(Application::InternalState::StoppedResumable, app1->internalState());
+    EXPECT_EQ(app1, applicationManager.findApplication("app1"));
+}
+
+TEST_F(MemoryPolicyTest, visibleApplicationsAreLeftAlone)
+{
+    auto app1 = startRunningApplication("app1");
+    auto app2 = startRunningApplication("app2");
+    auto app3 = startRunningApplication("app3");
+    focus(app3);
+
+    // eg. windows side by side on a desktop
+    surfaces[0]->registerView(1);
+    surfaces[0]->setViewExposure(1, true);
+
+    pressureSource->pressure.some = 100;
+    pressureSource->pressure.full = 100;
+
+    EXPECT_EQ(app2, memoryPolicy.evaluate());
+    waitForCooldown();
+    EXPECT_EQ(nullptr, memoryPolicy.evaluate());
+    EXPECT_EQ(Application::RequestedRunning, app1->requestedState());
+    EXPECT_EQ(Application::InternalState::Running, app1->internalState());
+}
+
+TEST_F(MemoryPolicyTest, disabledUnlessEnabledInTheSettings)
+{
+    using namespace ::testing;
+
+    EXPECT_FALSE(memoryPolicy.isEnabled());
+
+    ON_CALL(settings, get(QString("memoryPolicyEnabled"))).WillByDefault(Return(QVariant(true)));
+    ON_CALL(settings, get(QString("memoryPolicySuspendPressure"))).WillByDefault(Return(QVariant(42.0)));
+    ON_CALL(settings, get(QString("memoryPolicyCooldown"))).WillByDefault(Return(QVariant(30000)));
+    Q_EMIT settings.changed("memoryPolicyEnabled");
+
+    EXPECT_TRUE(memoryPolicy.isEnabled());
+    EXPECT_EQ(42.0, memoryPolicy.thresholds().suspendPressure);
+    EXPECT_EQ(30000, memoryPolicy.thresholds().cooldownMs);
+    EXPECT_EQ(5, memoryPolicy.thresholds().terminatePressure); // not set, default kept
+}
+
+TEST_F(MemoryPolicyTest, suspendsBackgroundApplicationsUsingTooMuchMemory)
+{
+    using namespace ::testing;
+
+    auto app1 = startRunningApplication("app1");
+    auto app2 = startRunningApplication("app2");
+    auto app3 = startRunningApplication("app3");
+    focus(app3);
+
+    const qint64 limit = 100 * 1024 * 1024;
+    ON_CALL(procInfo, residentMemory(app1->sessions()[0]->pid())).WillByDefault(Return(limit / 2));
+    ON_CALL(procInfo, residentMemory(app2->sessions()[0]->pid())).WillByDefault(Return(limit * 2));
+
+    EXPECT_EQ(nullptr, memoryPolicy.evaluate()); // no limit by default
+
+    auto thresholds = memoryPolicy.thresholds();
+    thresholds.backgroundMemoryLimit = limit;
+    memoryPolicy.setThresholds(thresholds);
+
+    EXPECT_EQ(app2, memoryPolicy.evaluate());
+    waitForCooldown();
+    EXPECT_EQ(nullptr, memoryPolicy.evaluate());
+    EXPECT_EQ(Application::RequestedRunning, app1->requestedState());
+}
+
+TEST(ProcMemoryPressureSourceTest, readsTenSecondsAverages)
+{
+    QTemporaryDir dir;
+    const QString path = dir.path() + "/memory";
+    {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write("some avg10=12.34 avg60=5.00 avg300=1.00 total=123456\n"
+                   "full avg10=3.21 avg60=1.00 avg300=0.50 total=65432\n");
+    }
+
+    MemoryPressure pressure;
+    EXPECT_TRUE(ProcMemoryPressureSource(path).read(pressure));
+    EXPECT_DOUBLE_EQ(12.34, pressure.some);
+    EXPECT_DOUBLE_EQ(3.21, pressure.full);
+
+    EXPECT_FALSE(ProcMemoryPressureSource(dir.path() + "/missing").read(pressure));
+}
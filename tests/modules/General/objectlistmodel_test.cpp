@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2014-2015 Canonical, Ltd.
+ * Copyright (C) 2014-2017 Canonical, Ltd.
  *
  * This program is free software: you can redistribute it and/or modify it under
  * the terms of the GNU Lesser General Public License version 3, as published by
@@ -19,6 +19,9 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include <random>
+#include <vector>
+
 using namespace qtmir;
 
 TEST(ObjectListModelTests, TestInsert)
@@ -129,3 +132,211 @@ TEST(ObjectListModelTests, TestRemove)
     model.remove(&object6);
     EXPECT_THAT(model.list(), ElementsAre(&object2, &object4));
 }
+
+namespace {
+
+struct RowSignals
+{
+    explicit RowSignals(QAbstractItemModel *model)
+    {
+        QObject::connect(model, &QAbstractItemModel::rowsInserted, [this](const QModelIndex&, int first, int last) {
+            inserted.append(qMakePair(first, last));
+        });
+        QObject::connect(model, &QAbstractItemModel::rowsRemoved, [this](const QModelIndex&, int first, int last) {
+            removed.append(qMakePair(first, last));
+        });
+        QObject::connect(model, &QAbstractItemModel::rowsMoved, [this](const QModelIndex&, int, int, const QModelIndex&, int) {
+            ++moved;
+        });
+        QObject::connect(model, &QAbstractItemModel::modelReset, [this]() {
+            ++reset;
+        });
+    }
+
+    QList<QPair<int,int>> inserted;
+    QList<QPair<int,int>> removed;
+    int moved{0};
+    int reset{0};
+};
+
+class TestableObjectListModel : public ObjectListModel<QObject>
+{
+public:
+    using ObjectListModel<QObject>::move;
+};
+
+} // anonymous namespace
+
+TEST(ObjectListModelTests, TestBatchInsert)
+{
+    using namespace testing;
+
+    ObjectListModel<QObject> model;
+    RowSignals rowSignals(&model);
+    QObject object1;
+    QObject object2;
+    QObject object3;
+    QObject object4;
+
+    model.insert(0, &object1);
+    model.insert(1, &object2);
+
+    // already present and duplicated items are inserted once
+    model.insert(1, {&object3, &object1, &object4, &object3});
+    EXPECT_THAT(model.list(), ElementsAre(&object1, &object3, &object4, &object2));
+    EXPECT_EQ(qMakePair(1, 2), rowSignals.inserted.last());
+    EXPECT_EQ(3, rowSignals.inserted.count());
+
+    for (int i = 0; i < model.rowCount(); ++i) {
+        EXPECT_EQ(i, model.indexOf(model.list()[i]));
+    }
+
+    // nothing new
+    model.insert(0, {&object4, &object2});
+    EXPECT_EQ(3, rowSignals.inserted.count());
+}
+
+TEST(ObjectListModelTests, TestBatchRemove)
+{
+    using namespace testing;
+
+    ObjectListModel<QObject> model;
+    RowSignals rowSignals(&model);
+    QObject objects[6];
+    QObject other;
+
+    for (int i = 0; i < 6; ++i) {
+        model.insert(i, &objects[i]);
+    }
+
+    model.remove({&objects[4], &other, &objects[1], &objects[2], &objects[1]});
+    EXPECT_THAT(model.list(), ElementsAre(&objects[0], &objects[3], &objects[5]));
+    EXPECT_FALSE(model.contains(&objects[1]));
+    EXPECT_EQ(2, model.indexOf(&objects[5]));
+
+    // one signal per contiguous block, bottom up
+    ASSERT_EQ(2, rowSignals.removed.count());
+    EXPECT_EQ(qMakePair(4, 4), rowSignals.removed[0]);
+    EXPECT_EQ(qMakePair(1, 2), rowSignals.removed[1]);
+}
+
+TEST(ObjectListModelTests, TestBlockMove)
+{
+    using namespace testing;
+
+    TestableObjectListModel model;
+    RowSignals rowSignals(&model);
+    QObject objects[6];
+
+    for (int i = 0; i < 6; ++i) {
+        model.insert(i, &objects[i]);
+    }
+
+    // down
+    model.move(1, 2, 3);
+    EXPECT_THAT(model.list(), ElementsAre(&objects[0], &objects[3], &objects[4], &objects[1], &objects[2], &objects[5]));
+
+    // up
+    model.move(3, 5, 0);
+    EXPECT_THAT(model.list(), ElementsAre(&objects[1], &objects[2], &objects[5], &objects[0], &objects[3], &objects[4]));
+
+    // past the end
+    model.move(4, 5, 5);
+    EXPECT_THAT(model.list(), ElementsAre(&objects[1], &objects[2], &objects[5], &objects[0], &objects[3], &objects[4]));
+
+    EXPECT_EQ(2, rowSignals.moved);
+    for (int i = 0; i < model.rowCount(); ++i) {
+        EXPECT_EQ(i, model.indexOf(model.list()[i]));
+    }
+}
+
+TEST(ObjectListModelTests, TestReset)
+{
+    using namespace testing;
+
+    ObjectListModel<QObject> model;
+    RowSignals rowSignals(&model);
+    QObject object1;
+    QObject object2;
+    QObject object3;
+
+    model.insert(0, &object1);
+
+    model.reset({&object3, &object2, &object3});
+    EXPECT_THAT(model.list(), ElementsAre(&object3, &object2));
+    EXPECT_FALSE(model.contains(&object1));
+    EXPECT_EQ(1, model.indexOf(&object2));
+    EXPECT_EQ(1, rowSignals.reset);
+    EXPECT_EQ(1, rowSignals.inserted.count());
+}
+
+TEST(ObjectListModelTests, LookupsFollowRandomEditsOfALargeModel)
+{
+    const int size = 2000;
+
+    std::vector<QObject> objects(size);
+    QList<QObject*> expected;
+    for (QObject &object : objects) {
+        expected.append(&object);
+    }
+
+    ObjectListModel<QObject> model;
+    model.reset(expected);
+
+    std::mt19937 random(11); // fixed seed, failures must be reproducible
+    for (int edit = 0; edit < 200; ++edit) {
+        std::uniform_int_distribution<int> objectIndex(0, size - 1);
+        QObject *object = &objects[objectIndex(random)];
+        const uint row = std::uniform_int_distribution<int>(0, expected.count())(random);
+
+        if (!expected.contains(object)) {
+            expected.insert(row, object);
+            model.insert(row, object);
+        } else if (edit % 2) {
+            expected.move(expected.indexOf(object), qMin<int>(row, expected.count() - 1));
+            model.insert(row, object);
+        } else {
+            expected.removeOne(object);
+            model.remove(object);
+        }
+
+        ASSERT_EQ(expected, model.list()) << "after edit " << edit;
+    }
+
+    for (QObject &object : objects) {
+        ASSERT_EQ(expected.indexOf(&object), model.indexOf(&object));
+        ASSERT_EQ(expected.contains(&object), model.contains(&object));
+    }
+}
+
+TEST(ObjectListModelTests, LargeBatchRemoveIsOneSignalPerBlock)
+{
+    const int size = 20000;
+
+    std::vector<QObject> objects(size);
+    QList<QObject*> items;
+    for (QObject &object : objects) {
+        items.append(&object);
+    }
+
+    ObjectListModel<QObject> model;
+    model.reset(items);
+    RowSignals rowSignals(&model);
+
+    // every other block of 100
+    QList<QObject*> toRemove;
+    for (int i = 0; i < size; ++i) {
+        if ((i / 100) % 2 == 0) {
+            toRemove.append(items[i]);
+        }
+    }
+
+    model.remove(toRemove);
+
+    EXPECT_EQ(size / 2, model.rowCount());
+    EXPECT_EQ(size / 200, rowSignals.removed.count());
+    for (int i = 0; i < model.rowCount(); ++i) {
+        ASSERT_EQ(i, model.indexOf(model.list()[i]));
+        ASSERT_EQ(1, (model.list()[i] - &objects[0]) / 100 % 2);
+    }
+}
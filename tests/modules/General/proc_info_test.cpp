@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2017 Canonical, Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License version 3, as published by
+ * the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranties of MERCHANTABILITY,
+ * SATISFACTORY QUALITY, or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Unity/Application/proc_info.h>
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <unistd.h>
+
+using namespace qtmir;
+
+// Lays out a directory looking like /proc for the processes the tests need
+class ProcInfoTest : public ::testing::Test
+{
+protected:
+    void writeProcFile(pid_t pid, const char *name, const QByteArray &contents)
+    {
+        const QString processDir = QStringLiteral("%1/%2").arg(procDir.path()).arg(pid);
+        ASSERT_TRUE(QDir().mkpath(processDir));
+
+        QFile file(QStringLiteral("%1/%2").arg(processDir).arg(name));
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        ASSERT_EQ(contents.size(), file.write(contents));
+    }
+
+    QTemporaryDir procDir;
+    ProcInfo procInfo{procDir.path().toUtf8()};
+};
+
+TEST_F(ProcInfoTest, commandLineKeepsArgumentsIntact)
+{
+    const char cmdline[] = "/usr/bin/my-app\0--desktop_file_hint=/usr/share/applications/my app.desktop\0--verbose\0";
+    writeProcFile(1234, "cmdline", QByteArray(cmdline, sizeof(cmdline) - 1));
+
+    auto commandLine = procInfo.commandLine(1234);
+    ASSERT_NE(nullptr, commandLine);
+
+    EXPECT_TRUE(commandLine->startsWith("/usr/bin/my-app"));
+    EXPECT_EQ(QStringList({"/usr/bin/my-app", "--desktop_file_hint=/usr/share/applications/my app.desktop", "--verbose"}),
+              commandLine->asStringList());
+    EXPECT_EQ(QString("/usr/share/applications/my app.desktop"), commandLine->getParameter("--desktop_file_hint="));
+    EXPECT_TRUE(commandLine->getParameter("--verbose").isNull());
+    EXPECT_TRUE(commandLine->getParameter("--missing=").isNull());
+}
+
+TEST_F(ProcInfoTest, environmentLookupsAreExact)
+{
+    const char variables[] =
+        "XDESKTOP_FILE_HINT=wrong.desktop\0"
+        "DESKTOP_FILE_HINT=/usr/share/applications/app.desktop\0"
+        "MULTILINE=first\nsecond\0"
+        "EMPTY=\0";
+    writeProcFile(1234, "environ", QByteArray(variables, sizeof(variables) - 1));
+
+    auto environment = procInfo.environment(1234);
+    ASSERT_NE(nullptr, environment);
+
+    EXPECT_TRUE(environment->contains("DESKTOP_FILE_HINT"));
+    EXPECT_EQ(QString("/usr/share/applications/app.desktop"), environment->getParameter("DESKTOP_FILE_HINT"));
+    EXPECT_EQ(QString("first\nsecond"), environment->getParameter("MULTILINE"));
+
+    EXPECT_FALSE(environment->contains("DESKTOP_FILE"));
+    EXPECT_TRUE(environment->getParameter("DESKTOP_FILE").isNull());
+
+    EXPECT_TRUE(environment->contains("EMPTY"));
+    EXPECT_TRUE(environment->getParameter("EMPTY").isNull());
+}
+
+TEST_F(ProcInfoTest, readsFilesLargerThanTheReadBuffer)
+{
+    QByteArray variables;
+    for (int i = 0; i < 2000; ++i) {
+        variables += QStringLiteral("VARIABLE_%1=%2").arg(i).arg(QString(40, 'x')).toUtf8();
+        variables += '\0';
+    }
+    variables += "LAST=value";
+    variables += '\0';
+    writeProcFile(1234, "environ", variables);
+
+    auto environment = procInfo.environment(1234);
+    ASSERT_NE(nullptr, environment);
+    EXPECT_EQ(variables, environment->m_environment);
+    EXPECT_EQ(QString("value"), environment->getParameter("LAST"));
+}
+
+TEST_F(ProcInfoTest, processWithoutProcEntryIsNotFound)
+{
+    EXPECT_EQ(nullptr, procInfo.commandLine(4321));
+    EXPECT_EQ(nullptr, procInfo.environment(4321));
+}
+
+TEST_F(ProcInfoTest, emptyCommandLineHasNoArguments)
+{
+    writeProcFile(1234, "cmdline", QByteArray()); // like kernel threads and zombies
+
+    auto commandLine = procInfo.commandLine(1234);
+    ASSERT_NE(nullptr, commandLine);
+    EXPECT_TRUE(commandLine->asStringList().isEmpty());
+    EXPECT_TRUE(commandLine->getParameter("--desktop_file_hint=").isNull());
+}
+
+// What the ApplicationManager does for every client connecting without being launched by upstart
+TEST_F(ProcInfoTest, desktopFileHintIsFoundAmongManyVariables)
+{
+    QByteArray variables;
+    for (int i = 0; i < 60; ++i) {
+        variables += QStringLiteral("VARIABLE_%1=some/typical/value:with/several:paths").arg(i).toUtf8();
+        variables += '\0';
+    }
+    variables += "DESKTOP_FILE_HINT=/usr/share/applications/app.desktop";
+    variables += '\0';
+    writeProcFile(1234, "environ", variables);
+    const char cmdline[] = "/usr/lib/app/app\0--some-option\0--another=1\0";
+    writeProcFile(1234, "cmdline", QByteArray(cmdline, sizeof(cmdline) - 1));
+
+    auto commandLine = procInfo.commandLine(1234);
+    ASSERT_NE(nullptr, commandLine);
+    EXPECT_TRUE(commandLine->getParameter("--desktop_file_hint=").isNull());
+    EXPECT_EQ(QString("/usr/share/applications/app.desktop"),
+              procInfo.environment(1234)->getParameter("DESKTOP_FILE_HINT"));
+}
+
+TEST_F(ProcInfoTest, residentMemoryIsReadFromStatm)
+{
+    writeProcFile(1234, "statm", "12345 678 90 12 0 345 0\n");
+    EXPECT_EQ(678 * sysconf(_SC_PAGESIZE), procInfo.residentMemory(1234));
+
+    writeProcFile(1235, "statm", "garbage");
+    EXPECT_EQ(-1, procInfo.residentMemory(1235));
+    EXPECT_EQ(-1, procInfo.residentMemory(4321));
+}
@@ -16,6 +16,7 @@
 
 #include <qtmir_test.h>
 #include <fake_mirsurface.h>
+#include <fake_session.h>
 
 #include "promptsession.h"
 #include <Unity/Application/application.h>
@@ -395,3 +396,210 @@ TEST_F(SessionTests, AlsoKillClosingSurfacesWhenKilled)
 
     delete surface;
 }
+
+TEST_F(SessionTests, SuspendTimeoutAdaptsToHowLongTheClientKeepsDrawing)
+{
+    using namespace testing;
+
+    const QString appId("test-app");
+    const pid_t procId = 5551;
+
+    auto mirSession = std::make_shared<MockSession>(appId.toStdString(), procId);
+    EXPECT_CALL(*mirSession, set_lifecycle_state(_)).Times(AnyNumber());
+
+    auto timeSource = QSharedPointer<FakeTimeSource>::create();
+    auto suspendTimer = new FakeTimer(timeSource);
+
+    auto session = std::make_shared<qtmir::Session>(mirSession, promptSessionManager);
+    session->setTimeSource(timeSource);
+    session->setSuspendTimer(suspendTimer);
+
+    FakeMirSurface *surface = new FakeMirSurface;
+    session->registerSurface(surface);
+    surface->setReady();
+    EXPECT_EQ(Session::Running, session->state());
+
+    auto passTime = [&](qint64 msecs) { timeSource->m_msecsSinceReference += msecs; };
+
+    // Suspends the session, the client drawing its last frame after the given time if positive
+    auto suspend = [&](qint64 drawing) {
+        const qint64 requested = timeSource->m_msecsSinceReference;
+        session->suspend();
+        EXPECT_EQ(Session::Suspending, session->state());
+        if (drawing > 0) {
+            passTime(drawing);
+            Q_EMIT surface->framesPosted();
+        }
+        timeSource->m_msecsSinceReference = suspendTimer->nextTimeoutTime();
+        suspendTimer->update();
+        EXPECT_EQ(Session::Suspended, session->state());
+        EXPECT_EQ(timeSource->m_msecsSinceReference - requested, session->lifecycleLatency().suspendLatency());
+    };
+
+    // Nothing known about the client yet
+    EXPECT_EQ(LifecycleLatency::defaultSuspendTimeout, suspendTimer->interval());
+
+    // Saving its state without drawing, which tells nothing
+    suspend(0);
+    EXPECT_EQ(LifecycleLatency::defaultSuspendTimeout, session->lifecycleLatency().suspendLatency());
+    EXPECT_EQ(-1, session->lifecycleLatency().acknowledgeLatency());
+    session->resume();
+    suspend(0);
+    EXPECT_EQ(LifecycleLatency::defaultSuspendTimeout, session->lifecycleLatency().suspendLatency());
+    session->resume();
+
+    suspend(100);
+    EXPECT_EQ(LifecycleLatency::defaultSuspendTimeout, session->lifecycleLatency().suspendLatency());
+    EXPECT_EQ(100, session->lifecycleLatency().acknowledgeLatency());
+    EXPECT_EQ(-1, session->lifecycleLatency().resumeLatency());
+
+    passTime(1000);
+    session->resume();
+    passTime(40);
+    Q_EMIT surface->framesPosted();
+    passTime(1000);
+    Q_EMIT surface->framesPosted(); // not the first frame after resuming anymore
+    EXPECT_EQ(40, session->lifecycleLatency().resumeLatency());
+
+    // Quick to acknowledge, so given less time from now on
+    suspend(10);
+    EXPECT_EQ(LifecycleLatency::minimumSuspendTimeout, session->lifecycleLatency().suspendLatency());
+    EXPECT_EQ(10, session->lifecycleLatency().acknowledgeLatency());
+
+    session->resume();
+    suspend(LifecycleLatency::minimumSuspendTimeout - 1);
+    session->resume();
+
+    // Suspended while still drawing last time, given more time again
+    suspend(10);
+    EXPECT_GT(session->lifecycleLatency().suspendLatency(), LifecycleLatency::minimumSuspendTimeout);
+
+    // Resumed before getting suspended, nothing gets measured
+    session->resume();
+    const QVariantMap latencies = session->lifecycleLatency().toVariantMap();
+    session->suspend();
+    passTime(100);
+    session->resume();
+    EXPECT_EQ(Session::Running, session->state());
+    Q_EMIT surface->framesPosted();
+    EXPECT_EQ(latencies, session->lifecycleLatency().toVariantMap());
+
+    delete surface;
+}
+
+TEST_F(SessionTests, WholeSessionTreeIsSuspendedAndResumedAtOnce)
+{
+    using namespace testing;
+
+    const int width = 3;
+    const int depth = 3;
+
+    auto timeSource = QSharedPointer<FakeTimeSource>::create();
+    QVector<Session*> sessions;
+    QVector<FakeMirSurface*> surfaces;
+    QVector<FakeSession*> otherSessions;
+
+    auto createSession = [&]() {
+        auto mirSession = std::make_shared<MockSession>("test-app", 5551);
+        EXPECT_CALL(*mirSession, set_lifecycle_state(mir_lifecycle_state_will_suspend)).Times(1);
+        EXPECT_CALL(*mirSession, set_lifecycle_state(mir_lifecycle_state_resumed)).Times(1);
+
+        auto session = new Session(mirSession, promptSessionManager);
+        session->setTimeSource(timeSource);
+        session->setSuspendTimer(new FakeTimer(timeSource));
+
+        FakeMirSurface *surface = new FakeMirSurface;
+        session->registerSurface(surface);
+        surface->setReady();
+
+        sessions.append(session);
+        surfaces.append(surface);
+        return session;
+    };
+
+    // Sessions have width children down to the given depth, the deepest ones have a FakeSession child each
+    std::function<Session*(int)> createTree = [&](int level) {
+        Session *session = createSession();
+        if (level + 1 < depth) {
+            for (int i = 0; i < width; ++i) {
+                session->addChildSession(createTree(level + 1));
+            }
+        } else {
+            auto other = new FakeSession;
+            other->setState(Session::Running);
+            session->addChildSession(other);
+            otherSessions.append(other);
+        }
+        return session;
+    };
+    QScopedPointer<Session> root(createTree(0));
+    ASSERT_EQ(1 + width + width * width, sessions.count());
+
+    root->suspend();
+
+    for (Session *session : sessions) {
+        EXPECT_EQ(Session::Suspending, session->state());
+        // Completion is tracked for the whole tree by the root alone
+        EXPECT_EQ(session == root.data(), session->suspendTimer()->isRunning());
+    }
+    for (FakeSession *other : otherSessions) {
+        EXPECT_EQ(Session::Suspending, other->state());
+    }
+
+    auto rootTimer = static_cast<FakeTimer*>(root->suspendTimer());
+    timeSource->m_msecsSinceReference = rootTimer->nextTimeoutTime();
+    rootTimer->update();
+
+    for (Session *session : sessions) {
+        EXPECT_EQ(Session::Suspended, session->state());
+    }
+    for (FakeMirSurface *surface : surfaces) {
+        EXPECT_FALSE(surface->isFrameDropperRunning());
+    }
+    for (FakeSession *other : otherSessions) {
+        EXPECT_EQ(Session::Suspending, other->state()); // complete their suspension themselves
+    }
+
+    root->resume();
+
+    for (Session *session : sessions) {
+        EXPECT_EQ(Session::Running, session->state());
+    }
+    for (FakeMirSurface *surface : surfaces) {
+        EXPECT_TRUE(surface->isFrameDropperRunning());
+    }
+    for (FakeSession *other : otherSessions) {
+        EXPECT_EQ(Session::Running, other->state());
+    }
+
+    qDeleteAll(surfaces);
+}
+
+TEST_F(SessionTests, ChildRemovedWhileSuspendingFinishesSuspendingOnItsOwn)
+{
+    using namespace testing;
+
+    auto mirSession = std::make_shared<MockSession>("test-app", 5551);
+    EXPECT_CALL(*mirSession, set_lifecycle_state(_)).Times(AnyNumber());
+
+    Session session(mirSession, promptSessionManager);
+    Session *child = new Session(mirSession, promptSessionManager);
+    FakeMirSurface *surface = new FakeMirSurface;
+    FakeMirSurface *childSurface = new FakeMirSurface;
+    session.registerSurface(surface);
+    child->registerSurface(childSurface);
+    surface->setReady();
+    childSurface->setReady();
+    session.addChildSession(child);
+
+    session.suspend();
+    EXPECT_EQ(Session::Suspending, child->state());
+    EXPECT_FALSE(child->suspendTimer()->isRunning());
+
+    session.removeChildSession(child);
+    EXPECT_TRUE(child->suspendTimer()->isRunning());
+
+    delete child;
+    delete childSurface;
+    delete surface;
+}
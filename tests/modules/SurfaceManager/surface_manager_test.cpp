@@ -246,7 +246,8 @@ TEST_F(SurfaceManagerTests, miralWindowMoveUpdatesMirSurfacePosition)
     QSignalSpy mirSurfacePositionSpy(mirSurface, &MirSurface::positionChanged);
 
     // Test
-    Q_EMIT wmNotifier.windowMoved(windowInfo, newPosition);
+    wmNotifier.postWindowMoved(windowInfo.window(), newPosition);
+    wmNotifier.flushGeometryChanges();
     qtApp->sendPostedEvents();
 
     // Check result
@@ -473,3 +474,53 @@ TEST_F(SurfaceManagerTests, surfaceManagerDoesNotDeleteLiveMirSurfaceWhenStopsBe
     // Check result
     ASSERT_EQ(0, mirSurfaceDestroyedSpy.count());
 }
+
+/*
+ * Test the changes MirAL made to windows during a transaction are all applied to their MirSurfaces
+ * by a single event, and several raises in it result in a single surfacesRaised signal
+ */
+TEST_F(SurfaceManagerTests, miralWindowChangesOfATransactionAppliedAtOnce)
+{
+    // Setup: add 2 windows, the first focused, and get their MirSurfaces
+    miral::Window window1(stubSession, stubSurface);
+    miral::Window window2(stubSession, stubSurface);
+    miral::WindowInfo windowInfo1(window1, spec);
+    miral::WindowInfo windowInfo2(window2, spec);
+    Q_EMIT wmNotifier.windowAdded(windowInfo1);
+    Q_EMIT wmNotifier.windowAdded(windowInfo2);
+    Q_EMIT wmNotifier.windowFocusChanged(windowInfo1, true);
+    qtApp->sendPostedEvents();
+    auto mirSurface1 = surfaceManager->find(windowInfo1);
+    auto mirSurface2 = surfaceManager->find(windowInfo2);
+    ASSERT_TRUE(mirSurface1);
+    ASSERT_TRUE(mirSurface2);
+
+    QSignalSpy mirSurfacesRaisedSpy(surfaceManager.data(), &SurfaceManager::surfacesRaised);
+    QSignalSpy mirSurfacePositionSpy(mirSurface2, &MirSurface::positionChanged);
+
+    // Test
+    WindowModelChanges changes;
+    changes.moved[window2] = QPoint(10, 20);
+    changes.moved[window2] = QPoint(30, 40);
+    changes.focusChanged[window2] = true;
+    changes.focusChanged[window1] = false;
+    changes.stateChanged[window2] = Mir::MaximizedState;
+    changes.raise({window2, window1});
+    changes.raise({window2});
+    Q_EMIT wmNotifier.windowsChanged(changes);
+    qtApp->sendPostedEvents();
+
+    // Check results
+    EXPECT_EQ(1, mirSurfacePositionSpy.count());
+    EXPECT_EQ(QPoint(30, 40), mirSurface2->position());
+    EXPECT_FALSE(mirSurface1->focused());
+    EXPECT_TRUE(mirSurface2->focused());
+    EXPECT_EQ(Mir::MaximizedState, mirSurface2->state());
+
+    ASSERT_EQ(1, mirSurfacesRaisedSpy.count());
+    auto raiseMirSurfaceList = qvariant_cast<QVector<unity::shell::application::MirSurfaceInterface*>>(
+                                                 mirSurfacesRaisedSpy.takeFirst().at(0)); // first argument of signal
+    ASSERT_EQ(2, raiseMirSurfaceList.count());
+    EXPECT_EQ(mirSurface1, raiseMirSurfaceList.at(0));
+    EXPECT_EQ(mirSurface2, raiseMirSurfaceList.at(1));
+}
@@ -51,6 +51,7 @@ struct MirEvent {}; // otherwise won't compile otherwise due to incomplete type
 // miral
 #include <miral/window.h>
 #include <miral/window_info.h>
+#include <miral/window_specification.h>
 
 using namespace qtmir;
 
@@ -174,3 +175,35 @@ TEST_F(MirSurfaceTest, failedSurfaceCloseEventuallyDestroysSurface)
     surface.setLive(false);
     surface.unregisterView(view);
 }
+
+/*
+ * Test that the input area of a MirSurface is exactly the union of the rectangles of its input shape,
+ * not their bounding rectangle
+ */
+TEST_F(MirSurfaceTest, InputAreaFollowsInputShapeRectangles)
+{
+    miral::Window window(stubSession, stubSurface);
+    ms::SurfaceCreationParameters spec;
+    miral::WindowInfo windowInfo(window, spec);
+
+    MirSurface surface(windowInfo, nullptr);
+    EXPECT_TRUE(surface.inputAreaContains(QPoint(500, 500))); // no input shape means the whole surface
+
+    QSignalSpy inputBoundsSpy(&surface, &MirSurface::inputBoundsChanged);
+
+    // L shaped: a title bar on top of a narrower body
+    miral::WindowSpecification modifications;
+    modifications.input_shape() = std::vector<mir::geometry::Rectangle>{
+        {{0, 0}, {100, 20}},
+        {{0, 20}, {40, 80}}
+    };
+    surface.surfaceObserver()->notifySurfaceModifications(modifications);
+
+    EXPECT_EQ(1, inputBoundsSpy.count());
+    EXPECT_EQ(QRect(0, 0, 100, 100), surface.inputBounds());
+
+    EXPECT_TRUE(surface.inputAreaContains(QPoint(90, 10)));
+    EXPECT_TRUE(surface.inputAreaContains(QPoint(10, 90)));
+    EXPECT_FALSE(surface.inputAreaContains(QPoint(90, 90))); // inside the bounds, outside the shape
+    EXPECT_FALSE(surface.inputAreaContains(QPoint(100, 10)));
+}
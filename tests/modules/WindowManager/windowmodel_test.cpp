@@ -30,6 +30,11 @@
 
 #include <mir/scene/surface_creation_parameters.h>
 
+#include <algorithm>
+#include <map>
+#include <random>
+#include <thread>
+
 using namespace qtmir;
 
 namespace ms = mir::scene;
@@ -551,7 +556,8 @@ TEST_F(WindowModelTest, WindowMoveUpdatesMirSurface)
     auto surface = getMirSurfaceFromModel(model, 0);
 
     // Move window, check new position set
-    notifier.windowMoved(newWindow.windowInfo, newPosition);
+    notifier.postWindowMoved(newWindow.windowInfo.window(), newPosition);
+    notifier.flushGeometryChanges();
     flushEvents();
 
     EXPECT_EQ(newPosition, surface->position());
@@ -576,7 +582,8 @@ TEST_F(WindowModelTest, WindowMoveUpdatesCorrectMirSurface)
     auto surface = getMirSurfaceFromModel(model, 0); // will be MirSurface for newWindow1
 
     // Move window, check new position set
-    notifier.windowMoved(newWindow1.windowInfo, newPosition);
+    notifier.postWindowMoved(newWindow1.windowInfo.window(), newPosition);
+    notifier.flushGeometryChanges();
     flushEvents();
 
     EXPECT_EQ(newPosition, surface->position());
@@ -600,7 +607,8 @@ TEST_F(WindowModelTest, DISABLED_WindowMoveDoesNotTouchOtherMirSurfaces)
     auto surface = getMirSurfaceFromModel(model, 1); // will be MirSurface for newWindow2
 
     // Move window, check new position set
-    notifier.windowMoved(newWindow1.windowInfo, QPoint(350, 420));
+    notifier.postWindowMoved(newWindow1.windowInfo.window(), QPoint(350, 420));
+    notifier.flushGeometryChanges();
     flushEvents();
 
     // Ensure other window untouched
@@ -784,3 +792,336 @@ TEST_P(WindowModelTestTypes, WhenWindowStateChangedMirSurfaceEmitsStateChangedSi
 const Mir::State allKnownStates[] = {Mir::RestoredState, Mir::MinimizedState, Mir::MaximizedState, Mir::VertMaximizedState,
                                      Mir::FullscreenState, Mir::HorizMaximizedState, Mir::HiddenState};
 INSTANTIATE_TEST_CASE_P(WindowTypes, WindowModelTestTypes, ::testing::ValuesIn(allKnownStates));
+
+/*
+ * Test: the window to surface index follows rows being removed and raised
+ */
+TEST_F(WindowModelTest, WindowMoveUpdatesCorrectMirSurfaceAfterRemoveAndRaise)
+{
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+
+    auto newWindow1 = createNewWindow();
+    auto newWindow2 = createNewWindow();
+    auto newWindow3 = createNewWindow();
+    auto newWindow4 = createNewWindow();
+    notifier.windowAdded(newWindow1);
+    notifier.windowAdded(newWindow2);
+    notifier.windowAdded(newWindow3);
+    notifier.windowAdded(newWindow4);
+
+    notifier.windowRemoved(newWindow1.windowInfo);
+    notifier.windowsRaised({newWindow2.windowInfo.window()});
+
+    // Model should now be like this:
+    // 2:   Window2
+    // 1:   Window4
+    // 0:   Window3
+    flushEvents();
+    ASSERT_EQ(3, model.count());
+
+    QPoint position(10, 10);
+    for (const auto &newWindow : {newWindow2, newWindow3, newWindow4}) {
+        notifier.postWindowMoved(newWindow.windowInfo.window(), position);
+        position += QPoint(10, 10);
+    }
+    notifier.flushGeometryChanges();
+    flushEvents();
+
+    EXPECT_EQ(QPoint(10, 10), getMirSurfaceFromModel(model, 2)->position());
+    EXPECT_EQ(QPoint(20, 20), getMirSurfaceFromModel(model, 0)->position());
+    EXPECT_EQ(QPoint(30, 30), getMirSurfaceFromModel(model, 1)->position());
+}
+
+/*
+ * Test: among many windows, each move reaches the MirSurface of its window, also once windows were removed
+ * and raised in between
+ */
+TEST_F(WindowModelTest, WindowMovesReachTheirSurfaceAmongManyWindows)
+{
+    const int windowCount = 500;
+
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+
+    std::vector<NewWindow> windows;
+    for (int i = 0; i < windowCount; i++) {
+        windows.push_back(createNewWindow());
+        notifier.windowAdded(windows.back());
+    }
+    for (int i = 0; i < windowCount; i += 3) {
+        notifier.windowRemoved(windows[i].windowInfo);
+    }
+    notifier.windowsRaised({windows[1].windowInfo.window(), windows[windowCount / 2].windowInfo.window()});
+    flushEvents();
+    ASSERT_EQ(windowCount - (windowCount + 2) / 3, model.count());
+
+    std::map<miral::Window, QPoint> positions;
+    for (int i = 0; i < windowCount; i++) {
+        if (i % 3 != 0) {
+            positions[windows[i].windowInfo.window()] = QPoint(i, i);
+            notifier.postWindowMoved(windows[i].windowInfo.window(), QPoint(i, i));
+        }
+    }
+    notifier.flushGeometryChanges();
+    flushEvents();
+
+    for (int row = 0; row < model.count(); row++) {
+        auto surface = getMirSurfaceFromModel(model, row);
+        EXPECT_EQ(positions.at(surface->window()), surface->position()) << "row " << row;
+    }
+}
+
+/*
+ * Test: random raises of random window stacks give the same order as restacking the windows one by one,
+ * using at most one row move per raised window
+ */
+TEST_F(WindowModelTest, RandomRaisesMatchNaiveRestacking)
+{
+    std::mt19937 random(42); // fixed seed, failures must be reproducible
+
+    for (int windowCount = 1; windowCount <= 40; windowCount++) {
+        WindowModelNotifier notifier;
+        WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+        QSignalSpy rowsMovedSpy(&model, &WindowModel::rowsMoved);
+
+        std::vector<miral::Window> expected;
+        for (int i = 0; i < windowCount; i++) {
+            auto newWindow = createNewWindow();
+            notifier.windowAdded(newWindow);
+            expected.push_back(newWindow.windowInfo.window());
+        }
+
+        for (int raise = 0; raise < 20; raise++) {
+            std::vector<miral::Window> raised = expected;
+            std::shuffle(raised.begin(), raised.end(), random);
+            raised.resize(std::uniform_int_distribution<int>(1, windowCount)(random));
+
+            // naive reference: take each raised window out and put it on top, in the order of the list
+            for (const auto &window : raised) {
+                expected.erase(std::find(expected.begin(), expected.end(), window));
+                expected.push_back(window);
+            }
+
+            rowsMovedSpy.clear();
+            notifier.windowsRaised(raised);
+            flushEvents();
+
+            ASSERT_LE(rowsMovedSpy.count(), static_cast<int>(raised.size()));
+            ASSERT_EQ(windowCount, model.count());
+            for (int i = 0; i < windowCount; i++) {
+                ASSERT_EQ(expected[i], getMirALWindowFromModel(model, i))
+                    << "row " << i << " of " << windowCount << " after raise " << raise;
+            }
+        }
+    }
+}
+
+/*
+ * Test: raising windows already at the top in the right order does not move any row, and raising a
+ * contiguous block of windows moves it in one go
+ */
+TEST_F(WindowModelTest, RaisingContiguousWindowsMovesThemAsOneBlock)
+{
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+
+    std::vector<miral::Window> windows;
+    for (int i = 0; i < 6; i++) {
+        auto newWindow = createNewWindow();
+        notifier.windowAdded(newWindow);
+        windows.push_back(newWindow.windowInfo.window());
+    }
+    flushEvents();
+
+    QSignalSpy rowsMovedSpy(&model, &WindowModel::rowsMoved);
+
+    notifier.windowsRaised({windows[4], windows[5]});
+    flushEvents();
+    EXPECT_EQ(0, rowsMovedSpy.count());
+
+    notifier.windowsRaised({windows[1], windows[2], windows[3]});
+    flushEvents();
+
+    // Model should now be like this:
+    // 5:   Window3
+    // 4:   Window2
+    // 3:   Window1
+    // 2:   Window5
+    // 1:   Window4
+    // 0:   Window0
+    ASSERT_EQ(1, rowsMovedSpy.count());
+    EXPECT_EQ(windows[3], getMirALWindowFromModel(model, 5));
+    EXPECT_EQ(windows[1], getMirALWindowFromModel(model, 3));
+    EXPECT_EQ(windows[5], getMirALWindowFromModel(model, 2));
+    EXPECT_EQ(windows[0], getMirALWindowFromModel(model, 0));
+}
+
+/*
+ * Test: the changes of a window management transaction are applied to the model by a single event
+ */
+TEST_F(WindowModelTest, WindowsChangedAppliesAllChangesOfTheTransaction)
+{
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+
+    auto newWindow1 = createNewWindow();
+    auto newWindow2 = createNewWindow();
+    auto newWindow3 = createNewWindow();
+    notifier.windowAdded(newWindow1);
+    notifier.windowAdded(newWindow2);
+    notifier.windowAdded(newWindow3);
+    flushEvents();
+
+    WindowModelChanges changes;
+    changes.moved[newWindow1.windowInfo.window()] = QPoint(10, 20);
+    changes.stateChanged[newWindow2.windowInfo.window()] = Mir::MinimizedState;
+    changes.raise({newWindow1.windowInfo.window(), newWindow2.windowInfo.window()});
+    changes.raise({newWindow1.windowInfo.window()});
+    notifier.windowsChanged(changes);
+    flushEvents();
+
+    // Model should now be like this:
+    // 2:   Window1
+    // 1:   Window2
+    // 0:   Window3
+    EXPECT_EQ(newWindow1.windowInfo.window(), getMirALWindowFromModel(model, 2));
+    EXPECT_EQ(newWindow2.windowInfo.window(), getMirALWindowFromModel(model, 1));
+    EXPECT_EQ(newWindow3.windowInfo.window(), getMirALWindowFromModel(model, 0));
+
+    EXPECT_EQ(QPoint(10, 20), getMirSurfaceFromModel(model, 2)->position());
+    EXPECT_EQ(Mir::MinimizedState, getMirSurfaceFromModel(model, 1)->state());
+}
+
+/*
+ * Test: window moves posted faster than the Qt side processes them are coalesced, only the latest position
+ * of each window reaches its MirSurface
+ */
+TEST_F(WindowModelTest, PostedWindowMovesAreCoalesced)
+{
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+
+    auto newWindow1 = createNewWindow();
+    auto newWindow2 = createNewWindow();
+    notifier.windowAdded(newWindow1);
+    notifier.windowAdded(newWindow2);
+
+    auto surface1 = getMirSurfaceFromModel(model, 0);
+    auto surface2 = getMirSurfaceFromModel(model, 1);
+    QSignalSpy positionSpy1(surface1, &MirSurface::positionChanged);
+    QSignalSpy positionSpy2(surface2, &MirSurface::positionChanged);
+
+    // Mir posts from its own threads
+    std::thread mirThread([&]() {
+        for (int i = 1; i <= 100; i++) {
+            notifier.postWindowMoved(newWindow1.windowInfo.window(), QPoint(i, i));
+        }
+        notifier.postWindowMoved(newWindow2.windowInfo.window(), QPoint(5, 5));
+    });
+    mirThread.join();
+    flushEvents();
+    flushEvents();
+
+    EXPECT_EQ(1, positionSpy1.count());
+    EXPECT_EQ(QPoint(100, 100), surface1->position());
+    EXPECT_EQ(1, positionSpy2.count());
+    EXPECT_EQ(QPoint(5, 5), surface2->position());
+    EXPECT_EQ(99u, notifier.collapsedMoves());
+
+    // Once delivered, the next move is delivered on its own again
+    notifier.postWindowMoved(newWindow1.windowInfo.window(), QPoint(7, 7));
+    flushEvents();
+    flushEvents();
+
+    EXPECT_EQ(2, positionSpy1.count());
+    EXPECT_EQ(QPoint(7, 7), surface1->position());
+    EXPECT_EQ(99u, notifier.collapsedMoves());
+}
+
+/*
+ * Test: flushing the pending window geometry before emitting another signal keeps the order in which Mir
+ * made the changes, even if the delivery scheduled by the first post is still queued
+ */
+TEST_F(WindowModelTest, FlushedGeometryIsDeliveredAheadOfLaterSignals)
+{
+    WindowModelNotifier notifier;
+    auto newWindow = createNewWindow();
+
+    QObject receiver;
+    QStringList received;
+    QObject::connect(&notifier, &WindowModelNotifier::windowsChanged, &receiver,
+                     [&](const WindowModelChanges &) { received << "moved"; }, Qt::QueuedConnection);
+    QObject::connect(&notifier, &WindowModelNotifier::windowResized, &receiver,
+                     [&](const miral::WindowInfo &, const QSize) { received << "resized"; }, Qt::QueuedConnection);
+    QObject::connect(&notifier, &WindowModelNotifier::windowFocusChanged, &receiver,
+                     [&](const miral::WindowInfo &, bool) { received << "focused"; }, Qt::QueuedConnection);
+
+    // Mir posts from its own threads
+    std::thread mirThread([&]() {
+        notifier.postWindowMoved(newWindow.windowInfo.window(), QPoint(1, 1));
+        notifier.postWindowResized(newWindow.windowInfo, QSize(10, 10));
+        notifier.flushGeometryChanges();
+        Q_EMIT notifier.windowFocusChanged(newWindow.windowInfo, true);
+        notifier.postWindowMoved(newWindow.windowInfo.window(), QPoint(2, 2));
+    });
+    mirThread.join();
+    flushEvents();
+    flushEvents();
+
+    EXPECT_THAT(received, ElementsAre("moved", "resized", "focused", "moved"));
+}
+
+/*
+ * Test: the move of a window posted right after it was added is not delivered ahead of it by a delivery that
+ * was scheduled before the flush preceding its addition
+ */
+TEST_F(WindowModelTest, MoveOfANewWindowIsNotDeliveredBeforeItsAddition)
+{
+    WindowModelNotifier notifier;
+    WindowModel model(&notifier, nullptr); // no need for controller in this testcase
+
+    auto newWindow1 = createNewWindow(QPoint(10, 10));
+    auto newWindow2 = createNewWindow(QPoint(20, 20));
+    notifier.windowAdded(newWindow1);
+    flushEvents();
+
+    // Mir posts from its own threads
+    std::thread mirThread([&]() {
+        notifier.postWindowMoved(newWindow1.windowInfo.window(), QPoint(11, 11));
+        notifier.flushGeometryChanges();
+        Q_EMIT notifier.windowAdded(newWindow2);
+        notifier.postWindowMoved(newWindow2.windowInfo.window(), QPoint(21, 21));
+    });
+    mirThread.join();
+    flushEvents();
+    flushEvents();
+
+    ASSERT_EQ(2, model.count());
+    EXPECT_EQ(QPoint(11, 11), getMirSurfaceFromModel(model, 0)->position());
+    EXPECT_EQ(QPoint(21, 21), getMirSurfaceFromModel(model, 1)->position());
+}
+
+/*
+ * Test: a coalesced resize is delivered with the window info of the latest resize, not of the first one
+ */
+TEST_F(WindowModelTest, CoalescedResizeCarriesTheLatestWindowInfo)
+{
+    WindowModelNotifier notifier;
+    auto newWindow = createNewWindow();
+
+    miral::WindowInfo maximizedInfo = newWindow.windowInfo;
+    maximizedInfo.state(mir_window_state_maximized);
+
+    qRegisterMetaType<miral::WindowInfo>();
+    QSignalSpy resizedSpy(&notifier, &WindowModelNotifier::windowResized);
+
+    notifier.postWindowResized(newWindow.windowInfo, QSize(10, 10));
+    notifier.postWindowResized(maximizedInfo, QSize(20, 20));
+    flushEvents();
+
+    ASSERT_EQ(1, resizedSpy.count());
+    EXPECT_EQ(mir_window_state_maximized, resizedSpy.at(0).at(0).value<miral::WindowInfo>().state());
+    EXPECT_EQ(QSize(20, 20), resizedSpy.at(0).at(1).toSize());
+    EXPECT_EQ(1u, notifier.collapsedResizes());
+}